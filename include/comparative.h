@@ -69,6 +69,12 @@ public:
             cur_ = x;
         }
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const comparative_accumulator& other) {
+        push(other.cur_);
+    }
 
 
     //---------------------------------------------------------------
@@ -154,6 +160,12 @@ public:
             pq_.erase(it);
         }
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const reversible_comparative_accumulator& other) {
+        pq_.insert(other.pq_.begin(), other.pq_.end());
+    }
 
 
     //---------------------------------------------------------------
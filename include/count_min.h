@@ -0,0 +1,301 @@
+#ifndef AMLIB_STATISTICS_COUNT_MIN_H_
+#define AMLIB_STATISTICS_COUNT_MIN_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "hashing.h"
+
+
+namespace am {
+namespace stat {
+
+namespace detail {
+
+//-------------------------------------------------------------------
+/// @brief hint that *p will be written soon (no-op if unsupported)
+inline void
+prefetch_for_write(const void* p) noexcept
+{
+#ifdef __GNUC__
+    __builtin_prefetch(p, 1);
+#else
+    (void)p;
+#endif
+}
+
+} // namespace detail
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief approximate per-key counts in fixed memory
+ *        (Count-Min sketch; Cormode & Muthukrishnan, 2005)
+ *
+ * @details depth x width counters in one contiguous row-major block;
+ *          width is rounded up to a power of two;
+ *          one 64-bit hash per key is split into two 32-bit halves h1, h2;
+ *          row i uses column (h1 + i*h2) mod width
+ *          (Kirsch & Mitzenmacher, 2006);
+ *          estimates never undercount; with width >= e/epsilon and
+ *          depth >= ln(1/delta) the overcount is at most epsilon * total()
+ *          with probability 1-delta;
+ *          counters saturate at the maximum of 'Count' instead of wrapping
+ *          around (estimates are then capped at that value);
+ *          conservative update only raises the counters that are below the
+ *          new minimum (smaller overcounts, but the sketch cannot be used
+ *          for deletions and merged sketches lose the tighter bound)
+ *
+ *****************************************************************************/
+template<
+    class Key,
+    class Count = std::uint32_t,
+    class Hash = hash64<Key>
+>
+class count_min_accumulator
+{
+    static_assert(std::is_unsigned<Count>::value,
+        "count_min_accumulator: count type must be unsigned");
+
+    static constexpr std::size_t batch_size = 16;
+
+public:
+    //---------------------------------------------------------------
+    using key_type      = Key;
+    using count_type    = Count;
+    using argument_type = Key;
+    using result_type   = std::uint_least64_t;
+    using hasher        = Hash;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    /// @param width  counters per row (rounded up to a power of two)
+    /// @param depth  number of rows
+    explicit
+    count_min_accumulator(size_type width = 2048, size_type depth = 4,
+                          bool conservative = false,
+                          const hasher& hash = hasher{})
+    :
+        width_(1), depth_(depth > 0 ? depth : 1), mask_(0), total_(0),
+        conservative_(conservative), cells_{}, hash_(hash)
+    {
+        while(width_ < width && width_ < (size_type(1) << 31)) width_ <<= 1;
+        mask_ = width_ - 1;
+        cells_.assign(width_ * depth_, count_type(0));
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    width() const noexcept {
+        return width_;
+    }
+    //-----------------------------------------------------
+    size_type
+    depth() const noexcept {
+        return depth_;
+    }
+    //-----------------------------------------------------
+    bool
+    conservative() const noexcept {
+        return conservative_;
+    }
+    //-----------------------------------------------------
+    /// @brief total weight of all pushed keys
+    std::uint_least64_t
+    total() const noexcept {
+        return total_;
+    }
+    //-----------------------------------------------------
+    /// @brief expected maximum overcount relative to total() (e / width)
+    double
+    relative_error() const noexcept {
+        return std::exp(1.0) / double(width_);
+    }
+    //-----------------------------------------------------
+    /// @brief probability that an estimate exceeds the error bound
+    double
+    failure_probability() const noexcept {
+        return std::exp(-double(depth_));
+    }
+    //-----------------------------------------------------
+    /// @brief heap memory in bytes
+    std::size_t
+    memory_usage() const noexcept {
+        return cells_.capacity() * sizeof(count_type);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        std::fill(cells_.begin(), cells_.end(), count_type(0));
+        total_ = 0;
+    }
+    //-----------------------------------------------------
+    count_min_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    count_min_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x, count_type weight = 1) {
+        insert_hash(std::uint64_t(hash_(x)), weight);
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief hashes blocks of keys first and prefetches all their
+     *        counters before updating them, so that the cache misses
+     *        of different keys overlap
+     */
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        std::uint64_t hs[batch_size];
+        while(first != last) {
+            std::size_t n = 0;
+            for(; n < batch_size && first != last; ++n, ++first) {
+                hs[n] = std::uint64_t(hash_(*first));
+                for(size_type i = 0; i < depth_; ++i) {
+                    detail::prefetch_for_write(&cells_[cell(hs[n], i)]);
+                }
+            }
+            for(std::size_t j = 0; j < n; ++j) {
+                insert_hash(hs[j], 1);
+            }
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief inserts an already hashed key
+    void
+    insert_hash(std::uint64_t h, count_type weight = 1) {
+        total_ += weight;
+        if(conservative_) {
+            const auto target = saturating_add(estimate_hash(h), weight);
+            for(size_type i = 0; i < depth_; ++i) {
+                auto& c = cells_[cell(h, i)];
+                if(c < target) c = target;
+            }
+        }
+        else {
+            for(size_type i = 0; i < depth_; ++i) {
+                auto& c = cells_[cell(h, i)];
+                c = saturating_add(c, weight);
+            }
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief adds the counters of a sketch with the same dimensions
+    /// @return false, if the dimensions differ
+    bool
+    merge(const count_min_accumulator& other) {
+        if(other.width_ != width_ || other.depth_ != depth_) return false;
+        auto a = cells_.data();
+        const auto b = other.cells_.data();
+        const auto n = cells_.size();
+        for(std::size_t i = 0; i < n; ++i) a[i] = saturating_add(a[i], b[i]);
+        total_ += other.total_;
+        return true;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief estimated count of 'key' (never less than the true count)
+    count_type
+    estimate(const key_type& key) const {
+        return estimate_hash(std::uint64_t(hash_(key)));
+    }
+    //-----------------------------------------------------
+    count_type
+    operator [] (const key_type& key) const {
+        return estimate(key);
+    }
+    //-----------------------------------------------------
+    count_type
+    estimate_hash(std::uint64_t h) const noexcept {
+        auto m = cells_[cell(h, 0)];
+        for(size_type i = 1; i < depth_; ++i) {
+            const auto c = cells_[cell(h, i)];
+            if(c < m) m = c;
+        }
+        return m;
+    }
+    //-----------------------------------------------------
+    /// @brief total weight of all pushed keys
+    result_type
+    result() const noexcept {
+        return total_;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    static count_type
+    saturating_add(count_type a, count_type b) noexcept {
+        constexpr auto maxCount = std::numeric_limits<count_type>::max();
+        return (b > count_type(maxCount - a)) ? maxCount : count_type(a + b);
+    }
+    //-----------------------------------------------------
+    /// @brief position of the counter for hash h in row i
+    size_type
+    cell(std::uint64_t h, size_type i) const noexcept {
+        const auto h1 = std::uint32_t(h);
+        const auto h2 = std::uint32_t(h >> 32) | 1u;
+        return i * width_ + (size_type(h1 + std::uint32_t(i) * h2) & mask_);
+    }
+
+
+    //---------------------------------------------------------------
+    size_type width_;
+    size_type depth_;
+    size_type mask_;
+    std::uint_least64_t total_;
+    bool conservative_;
+    std::vector<count_type> cells_;
+    hasher hash_;
+};
+
+
+template<class K, class C, class H>
+constexpr std::size_t count_min_accumulator<K,C,H>::batch_size;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class K, class C, class H>
+inline decltype(auto)
+result(const count_min_accumulator<K,C,H>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -66,6 +66,12 @@ public:
     push(const argument_type& x) {
         cur_ = x;
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of a later sample
+    void
+    merge(const current_value_accumulator& later) {
+        cur_ = later.cur_;
+    }
 
 
     //---------------------------------------------------------------
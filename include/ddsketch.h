@@ -0,0 +1,602 @@
+#ifndef AMLIB_STATISTICS_DDSKETCH_H_
+#define AMLIB_STATISTICS_DDSKETCH_H_
+
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief maps positive values to bucket indices with a guaranteed relative
+ *        accuracy; log2 is approximated by reading the exponent and
+ *        mantissa bits of an IEEE 754 double (piecewise-linear interpolation)
+ *
+ *****************************************************************************/
+class ddsketch_log_mapping
+{
+public:
+    //---------------------------------------------------------------
+    /// @param relativeAccuracy  0 < alpha < 1
+    explicit
+    ddsketch_log_mapping(double relativeAccuracy = 0.01) noexcept :
+        alpha_(relativeAccuracy), multiplier_(0)
+    {
+        using std::log;
+        if(!(alpha_ > 0) || !(alpha_ < 1)) alpha_ = 0.01;
+        //bucket width in log space: ln(gamma); the piecewise-linear log2
+        //approximation has slope >= 1 per unit of ln(x)
+        multiplier_ = 1.0 / log((1 + alpha_) / (1 - alpha_));
+    }
+
+
+    //---------------------------------------------------------------
+    double
+    relative_accuracy() const noexcept {
+        return alpha_;
+    }
+    //-----------------------------------------------------
+    /// @brief smallest positive value that can be mapped
+    static constexpr double
+    min_indexable() noexcept {
+        return std::numeric_limits<double>::min();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief bucket index of a positive, normal value x
+    int
+    index(double x) const noexcept {
+        return int(std::floor(approx_log2(x) * multiplier_));
+    }
+    //-----------------------------------------------------
+    /// @brief lower bound of bucket i
+    double
+    lower_bound(int i) const noexcept {
+        return approx_exp2(double(i) / multiplier_);
+    }
+    //-----------------------------------------------------
+    /// @brief value with the smallest maximum relative error in bucket i
+    double
+    value(int i) const noexcept {
+        const auto lo = lower_bound(i);
+        const auto hi = lower_bound(i + 1);
+        return 2 * lo * hi / (lo + hi);
+    }
+
+
+    //---------------------------------------------------------------
+    friend bool
+    operator == (const ddsketch_log_mapping& a, const ddsketch_log_mapping& b) noexcept {
+        return a.multiplier_ == b.multiplier_;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /// @brief exponent + (mantissa - 1)
+    static double
+    approx_log2(double x) noexcept {
+        std::uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        const auto e = int((bits >> 52) & 0x7ff) - 1023;
+        const auto m = double(bits & 0xfffffffffffffull) / double(1ull << 52);
+        return double(e) + m;
+    }
+    //-----------------------------------------------------
+    /// @brief inverse of approx_log2
+    static double
+    approx_exp2(double y) noexcept {
+        const auto e = std::floor(y);
+        return std::ldexp(1 + (y - e), int(e));
+    }
+
+
+    //---------------------------------------------------------------
+    double alpha_;
+    double multiplier_;
+};
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief contiguous bucket counters; collapses the lowest buckets
+ *        when the range would exceed a maximum number of buckets
+ *
+ * @details the array grows with geometric slack on the side that is
+ *          extended (like std::vector), so a slowly widening range costs
+ *          amortized O(1) per new bucket; it is only reallocated and
+ *          re-centered when that slack is used up (at most 2 x max_buckets()
+ *          counters are allocated)
+ *
+ *****************************************************************************/
+template<class Count = std::uint64_t>
+class ddsketch_dense_store
+{
+public:
+    //---------------------------------------------------------------
+    using count_type = Count;
+    using size_type  = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    ddsketch_dense_store(size_type maxBuckets = 2048):
+        counts_{}, offset_(0), lo_(0), hi_(-1), total_(0),
+        maxBuckets_(maxBuckets > 0 ? maxBuckets : 1)
+    {}
+
+
+    //---------------------------------------------------------------
+    bool empty() const noexcept { return hi_ < lo_; }
+    count_type total() const noexcept { return total_; }
+    size_type max_buckets() const noexcept { return maxBuckets_; }
+    /// @brief number of buckets in the stored index range
+    size_type buckets() const noexcept { return size_type(hi_ - lo_ + 1); }
+    /// @brief number of allocated buckets (stored range + slack)
+    size_type capacity() const noexcept { return counts_.size(); }
+
+    //-----------------------------------------------------
+    void
+    clear() {
+        counts_.clear();
+        offset_ = 0;
+        lo_ = 0;
+        hi_ = -1;
+        total_ = 0;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    add(int i, count_type c = 1) {
+        if(empty()) {
+            counts_.assign(1, c);
+            offset_ = i;
+            lo_ = i;
+            hi_ = i;
+            total_ += c;
+            return;
+        }
+        const auto hi = std::max(i, hi_);
+        auto lo = std::min(i, lo_);
+        if(size_type(hi - lo) + 1 > maxBuckets_) lo = hi - int(maxBuckets_) + 1;
+        if(i < lo) i = lo;
+        extend(lo, hi);
+        counts_[size_type(i - offset_)] += c;
+        total_ += c;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief calls f(index,count) for all non-empty buckets in ascending order
+    template<class F>
+    void
+    for_each(F&& f) const {
+        for(int i = lo_; i <= hi_; ++i) {
+            const auto c = counts_[size_type(i - offset_)];
+            if(c > 0) f(i, c);
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief calls f(index,count) for all non-empty buckets in descending order
+    template<class F>
+    void
+    for_each_reverse(F&& f) const {
+        for(int i = hi_; i >= lo_; --i) {
+            const auto c = counts_[size_type(i - offset_)];
+            if(c > 0) f(i, c);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    merge(const ddsketch_dense_store& other) {
+        other.for_each([this](int i, count_type c) { add(i, c); });
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /**
+     * @brief makes [lo,hi] the stored range; counts below lo collapse into lo;
+     *        requires a non-empty store, lo <= hi, min(lo,lo_) <= lo and
+     *        max(hi,hi_) == hi
+     */
+    void
+    extend(int lo, int hi) {
+        if(lo == lo_ && hi == hi_) return;
+
+        //fits into the allocated array => collapse in place
+        if(lo >= offset_ && hi < offset_ + int(counts_.size())) {
+            if(lo > lo_) {
+                auto c = count_type(0);
+                const auto top = std::min(lo - 1, hi_);
+                for(int i = lo_; i <= top; ++i) {
+                    auto& x = counts_[size_type(i - offset_)];
+                    c += x;
+                    x = count_type(0);
+                }
+                counts_[size_type(lo - offset_)] += c;
+            }
+            lo_ = lo;
+            hi_ = hi;
+            return;
+        }
+
+        //new array with fresh slack on the extended side;
+        //the unused slack on the other side is kept
+        const auto n = size_type(hi - lo) + 1;
+        const auto slack = std::min(std::max(n, size_type(8)), maxBuckets_);
+        const auto down = lo < lo_;
+        auto keep = down ? size_type(offset_ + int(counts_.size()) - 1 - hi)
+                         : size_type((lo == lo_) ? lo - offset_ : 0);
+        keep = std::min(keep, 2 * maxBuckets_ - n - slack);
+        const auto offset = down ? lo - int(slack) : lo - int(keep);
+
+        auto counts = std::vector<count_type>(n + slack + keep, count_type(0));
+        for(int i = lo_; i <= hi_; ++i) {
+            counts[size_type(std::max(i, lo) - offset)] +=
+                counts_[size_type(i - offset_)];
+        }
+        counts_.swap(counts);
+        offset_ = offset;
+        lo_ = lo;
+        hi_ = hi;
+    }
+
+
+    //---------------------------------------------------------------
+    std::vector<count_type> counts_;
+    int offset_;        //index of counts_[0]
+    int lo_;            //stored index range [lo_,hi_]
+    int hi_;
+    count_type total_;
+    size_type maxBuckets_;
+};
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief ordered map of non-empty buckets; memory grows only with the number
+ *        of distinct buckets; collapses the lowest buckets when there are
+ *        more than a maximum number of them
+ *
+ *****************************************************************************/
+template<class Count = std::uint64_t>
+class ddsketch_sparse_store
+{
+public:
+    //---------------------------------------------------------------
+    using count_type = Count;
+    using size_type  = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    ddsketch_sparse_store(size_type maxBuckets = 2048):
+        counts_{}, total_(0),
+        maxBuckets_(maxBuckets > 0 ? maxBuckets : 1)
+    {}
+
+
+    //---------------------------------------------------------------
+    bool empty() const noexcept { return counts_.empty(); }
+    count_type total() const noexcept { return total_; }
+    size_type max_buckets() const noexcept { return maxBuckets_; }
+    size_type buckets() const noexcept { return counts_.size(); }
+
+    //-----------------------------------------------------
+    void
+    clear() {
+        counts_.clear();
+        total_ = 0;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    add(int i, count_type c = 1) {
+        //below the collapsed range
+        if(counts_.size() >= maxBuckets_ && i < counts_.begin()->first) {
+            i = counts_.begin()->first;
+        }
+        counts_[i] += c;
+        total_ += c;
+        while(counts_.size() > maxBuckets_) {
+            const auto lowest = counts_.begin();
+            std::next(lowest)->second += lowest->second;
+            counts_.erase(lowest);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    template<class F>
+    void
+    for_each(F&& f) const {
+        for(const auto& b : counts_) f(b.first, b.second);
+    }
+    //-----------------------------------------------------
+    template<class F>
+    void
+    for_each_reverse(F&& f) const {
+        for(auto i = counts_.rbegin(); i != counts_.rend(); ++i) {
+            f(i->first, i->second);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    merge(const ddsketch_sparse_store& other) {
+        other.for_each([this](int i, count_type c) { add(i, c); });
+    }
+
+
+private:
+    std::map<int,count_type> counts_;
+    count_type total_;
+    size_type maxBuckets_;
+};
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief quantile estimation with guaranteed relative accuracy (DDSketch;
+ *        Masson, Rim & Lee, 2019)
+ *
+ * @details every quantile estimate v' of the true value v satisfies
+ *          |v' - v| <= alpha * |v| as long as no buckets were collapsed;
+ *          positive and negative values go into separate stores
+ *          (indexed by magnitude), values close to zero are counted
+ *          separately; when a store reaches its bucket limit, its lowest
+ *          buckets are collapsed (high quantiles stay accurate)
+ *
+ * @tparam Store  ddsketch_dense_store (fast, contiguous) or
+ *                ddsketch_sparse_store (memory proportional to
+ *                the number of distinct buckets)
+ *
+ *****************************************************************************/
+template<class Arg, class Store = ddsketch_dense_store<>>
+class ddsketch_accumulator
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = double;
+    using store_type    = Store;
+    using count_type    = typename Store::count_type;
+    using size_type     = std::uint_least64_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    ddsketch_accumulator(double relativeAccuracy = 0.01,
+                         std::size_t maxBuckets = 2048)
+    :
+        mapping_(relativeAccuracy),
+        pos_(maxBuckets), neg_(maxBuckets),
+        zeros_(0), min_(0), max_(0), sum_(0)
+    {}
+
+
+    //---------------------------------------------------------------
+    double
+    relative_accuracy() const noexcept {
+        return mapping_.relative_accuracy();
+    }
+    //-----------------------------------------------------
+    size_type
+    size() const noexcept {
+        return size_type(zeros_ + pos_.total() + neg_.total());
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return size() < 1;
+    }
+    //-----------------------------------------------------
+    const store_type& positive_store() const noexcept { return pos_; }
+    const store_type& negative_store() const noexcept { return neg_; }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        pos_.clear();
+        neg_.clear();
+        zeros_ = 0;
+        min_ = 0;
+        max_ = 0;
+        sum_ = 0;
+    }
+    //-----------------------------------------------------
+    ddsketch_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    ddsketch_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        const auto v = double(x);
+        if(empty()) {
+            min_ = v;
+            max_ = v;
+        } else {
+            if(v < min_) min_ = v;
+            if(v > max_) max_ = v;
+        }
+        sum_ += v;
+
+        if(v > mapping_.min_indexable()) {
+            pos_.add(mapping_.index(v));
+        } else if(v < -mapping_.min_indexable()) {
+            neg_.add(mapping_.index(-v));
+        } else {
+            ++zeros_;
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief combines with a sketch that has the same relative accuracy
+    /// @return false, if the sketches are incompatible
+    bool
+    merge(const ddsketch_accumulator& other) {
+        if(!(mapping_ == other.mapping_)) return false;
+        if(other.empty()) return true;
+        if(empty()) {
+            min_ = other.min_;
+            max_ = other.max_;
+        } else {
+            if(other.min_ < min_) min_ = other.min_;
+            if(other.max_ > max_) max_ = other.max_;
+        }
+        sum_ += other.sum_;
+        zeros_ += other.zeros_;
+        pos_.merge(other.pos_);
+        neg_.merge(other.neg_);
+        return true;
+    }
+
+
+    //---------------------------------------------------------------
+    result_type min() const noexcept { return min_; }
+    result_type max() const noexcept { return max_; }
+    result_type sum() const noexcept { return sum_; }
+    //-----------------------------------------------------
+    result_type
+    mean() const noexcept {
+        return empty() ? result_type(0) : sum_ / result_type(size());
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief estimates the q-quantile (0 <= q <= 1); 0 if empty
+    result_type
+    quantile(double q) const {
+        if(empty()) return result_type(0);
+        if(!(q > 0)) return min_;
+        if(!(q < 1)) return max_;
+
+        const auto rank = q * double(size() - 1);
+        double cum = 0;
+        double res = max_;
+        bool found = false;
+
+        //negative values: largest magnitude first
+        neg_.for_each_reverse([&](int i, count_type c) {
+            if(found) return;
+            cum += double(c);
+            if(cum > rank) { res = -mapping_.value(i); found = true; }
+        });
+        if(found) return clamp(res);
+
+        cum += double(zeros_);
+        if(cum > rank) return 0;
+
+        pos_.for_each([&](int i, count_type c) {
+            if(found) return;
+            cum += double(c);
+            if(cum > rank) { res = mapping_.value(i); found = true; }
+        });
+        return clamp(res);
+    }
+    //-----------------------------------------------------
+    result_type
+    median() const {
+        return quantile(0.5);
+    }
+    //-----------------------------------------------------
+    result_type
+    result() const {
+        return median();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    result_type
+    clamp(result_type x) const noexcept {
+        return (x < min_) ? min_ : ((x > max_) ? max_ : x);
+    }
+
+
+    //---------------------------------------------------------------
+    ddsketch_log_mapping mapping_;
+    store_type pos_;
+    store_type neg_;
+    count_type zeros_;
+    result_type min_;
+    result_type max_;
+    result_type sum_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg>
+using sparse_ddsketch_accumulator =
+    ddsketch_accumulator<Arg,ddsketch_sparse_store<>>;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Store>
+inline decltype(auto)
+result(const ddsketch_accumulator<Arg,Store>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
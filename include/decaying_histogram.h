@@ -0,0 +1,215 @@
+#ifndef AMLIB_STATISTICS_DECAYING_HISTOGRAM_H_
+#define AMLIB_STATISTICS_DECAYING_HISTOGRAM_H_
+
+#include <cmath>
+#include <vector>
+#include <type_traits>
+
+#include "uniform_histogram.h"
+#include "nonuniform_histogram.h"
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief histogram decorator with exponentially decaying counts
+ *        a sample inserted at time t has weight exp(-rate * (now - t))
+ *
+ * @details forward decay: samples are inserted with weight
+ *          exp(rate * (t - landmark)) so that insertion is O(1) and
+ *          no bin is touched when time advances;
+ *          the stored counts are converted to decayed counts with one
+ *          global factor exp(-rate * (now - landmark));
+ *          if that exponent becomes too large all bins are rescaled once
+ *          and the landmark is moved to 'now'
+ *
+ * @tparam Histogram  uniform_histogram or nonuniform_histogram
+ *                    with a floating-point count type
+ *
+ *****************************************************************************/
+template<class Histogram, class Time = double>
+class decaying_histogram
+{
+public:
+    //---------------------------------------------------------------
+    using histogram_type = Histogram;
+    using result_type    = Histogram;
+    using argument_type  = typename Histogram::argument_type;
+    using count_type     = typename Histogram::count_type;
+    using time_type      = Time;
+
+    static_assert(std::is_floating_point<count_type>::value,
+        "decaying_histogram<H>: H must have a floating-point count type");
+
+
+    //---------------------------------------------------------------
+    /**
+     * @param hist  histogram that defines the bins
+     * @param rate  decay rate per time unit;
+     *              use ln(2) / halfLife for a given half life
+     */
+    explicit
+    decaying_histogram(histogram_type hist, count_type rate,
+                       time_type start = time_type(0))
+    :
+        hist_(std::move(hist)),
+        rate_((rate > 0) ? rate : count_type(0)),
+        landmark_(start), now_(start)
+    {
+        hist_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        hist_.clear();
+        landmark_ = now_;
+    }
+
+
+    //---------------------------------------------------------------
+    count_type
+    rate() const noexcept {
+        return rate_;
+    }
+    //-----------------------------------------------------
+    time_type
+    now() const noexcept {
+        return now_;
+    }
+    //-----------------------------------------------------
+    time_type
+    landmark() const noexcept {
+        return landmark_;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief advances the current time; earlier times are ignored
+    void
+    advance(const time_type& now) {
+        if(now > now_) {
+            now_ = now;
+            if(exponent(now_) > max_exponent()) renormalize();
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief inserts x at the current time
+    void
+    insert(const argument_type& x) {
+        hist_.insert(x, forward_weight());
+    }
+    //-----------------------------------------------------
+    /// @brief inserts x with weight w at the current time
+    void
+    insert(const argument_type& x, const count_type& w) {
+        hist_.insert(x, w * forward_weight());
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
+    void
+    insert(InputIterator begin, InputIterator end) {
+        const auto w = forward_weight();
+        for(; begin != end; ++begin) {
+            hist_.insert(*begin, w);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief factor that converts stored counts to decayed counts
+    count_type
+    scale_factor() const {
+        using std::exp;
+        return exp(-exponent(now_));
+    }
+
+    //-----------------------------------------------------
+    /// @brief decayed count of x's bin
+    count_type
+    operator () (const argument_type& x) const {
+        return hist_(x) * scale_factor();
+    }
+    //-----------------------------------------------------
+    /// @brief decayed total count
+    count_type
+    total() const {
+        return hist_.total() * scale_factor();
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief  histogram of counts relative to the landmark;
+     *         multiply by scale_factor() to get decayed counts;
+     *         relative frequencies don't depend on the scale
+     */
+    const result_type&
+    result() const noexcept {
+        return hist_;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    static constexpr count_type
+    max_exponent() noexcept {
+        return count_type(64);
+    }
+    //-----------------------------------------------------
+    count_type
+    exponent(const time_type& t) const {
+        return rate_ * count_type(t - landmark_);
+    }
+    //-----------------------------------------------------
+    count_type
+    forward_weight() const {
+        using std::exp;
+        return exp(exponent(now_));
+    }
+    //-----------------------------------------------------
+    void
+    renormalize() {
+        hist_.scale(scale_factor());
+        landmark_ = now_;
+    }
+
+
+    //---------------------------------------------------------------
+    histogram_type hist_;
+    count_type rate_;
+    time_type landmark_;
+    time_type now_;
+};
+
+
+
+//-------------------------------------------------------------------
+template<class Argument, class Count = double, class Time = double>
+using decaying_uniform_histogram = decaying_histogram<
+    uniform_histogram<Argument,std::vector<Count>>, Time>;
+
+template<class Argument, class Count = double, class Time = double>
+using decaying_nonuniform_histogram = decaying_histogram<
+    nonuniform_histogram<Argument,Count>, Time>;
+
+
+//-------------------------------------------------------------------
+template<class Histogram, class Time>
+inline decltype(auto)
+result(const decaying_histogram<Histogram,Time>& h) {
+    return h.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+#endif
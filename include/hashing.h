@@ -0,0 +1,51 @@
+#ifndef AMLIB_STATISTICS_HASHING_H_
+#define AMLIB_STATISTICS_HASHING_H_
+
+#include <cstdint>
+#include <functional>
+
+
+namespace am {
+namespace stat {
+
+namespace detail {
+
+//-------------------------------------------------------------------
+/// @brief 64-bit finalizer (from SplitMix64); bijective, full avalanche
+inline constexpr std::uint64_t
+mix64(std::uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace detail
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief 64-bit hash with well-distributed bits for sketches
+ *        (std::hash is often the identity for integers)
+ *
+ *****************************************************************************/
+template<class T>
+struct hash64
+{
+    std::uint64_t
+    operator () (const T& x) const noexcept(noexcept(std::hash<T>{}(x))) {
+        return detail::mix64(std::uint64_t(std::hash<T>{}(x)));
+    }
+};
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
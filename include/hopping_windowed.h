@@ -0,0 +1,217 @@
+#ifndef AMLIB_STATISTICS_HOPPING_WINDOWED_H_
+#define AMLIB_STATISTICS_HOPPING_WINDOWED_H_
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief hopping (or tumbling) time window over a mergeable accumulator:
+ *        the window spans 'panes' consecutive intervals of length 'hop'
+ *        and moves forward by one interval at a time
+ *
+ * @details the stream is split into panes; each sample goes into exactly
+ *          one partial accumulator (O(1) per sample);
+ *          a window is answered by merging its panes in temporal order
+ *          (O(panes) per emitted window);
+ *          requires a.merge(b) ('a' followed by the later sample 'b');
+ *          panes == 1 yields tumbling windows
+ *
+ * @tparam Time  time type; (Time - Time) / Time must be convertible
+ *               to an integer
+ *
+ *****************************************************************************/
+template<class Accumulator, class Time = double>
+class hopping_windowed
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = typename Accumulator::argument_type;
+    using result_type   = Accumulator;
+    using time_type     = Time;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    /**
+     * @param hop    duration of one pane (= distance between windows)
+     * @param panes  number of panes in the window
+     *               (the window spans hop * panes)
+     * @param start  start of the first pane
+     */
+    explicit
+    hopping_windowed(time_type hop, size_type panes,
+                     time_type start = time_type(0))
+    :
+        panes_(panes > 0 ? panes : 1),
+        hop_(hop), paneStart_(start), cur_(0)
+    {}
+
+
+    //---------------------------------------------------------------
+    size_type
+    panes() const noexcept {
+        return panes_.size();
+    }
+    //-----------------------------------------------------
+    const time_type&
+    hop() const noexcept {
+        return hop_;
+    }
+    //-----------------------------------------------------
+    /// @brief start of the current (newest) pane
+    const time_type&
+    pane_start() const noexcept {
+        return paneStart_;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        for(auto& p : panes_) p = Accumulator{};
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief advances the current time; earlier times are ignored;
+     *        completed windows are discarded
+     *        (use advance(now, emit) to receive them)
+     * @return number of completed panes
+     */
+    size_type
+    advance(const time_type& now) {
+        return advance(now, [](const time_type&, const result_type&) {});
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief advances the current time; earlier times are ignored;
+     *        calls emit(windowEnd, windowResult) for each completed window
+     *        (at most 'panes' times; all later windows would be empty)
+     * @return number of completed panes
+     */
+    template<class Consumer>
+    size_type
+    advance(const time_type& now, Consumer&& emit) {
+        if(!(hop_ > time_type(0)) || now < paneStart_ + hop_) return 0;
+
+        const auto steps = static_cast<size_type>((now - paneStart_) / hop_);
+        //after 'panes' steps all panes are empty
+        const auto m = (steps < panes_.size()) ? steps : panes_.size();
+
+        for(size_type s = 0; s < m; ++s) {
+            paneStart_ += hop_;
+            emit(paneStart_, result());
+            if(++cur_ >= panes_.size()) cur_ = 0;
+            panes_[cur_] = Accumulator{};
+        }
+        if(steps > m) {
+            paneStart_ += hop_ * time_type(steps - m);
+            cur_ = 0;
+        }
+        return steps;
+    }
+
+
+    //---------------------------------------------------------------
+    hopping_windowed&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    /// @brief inserts x into the current pane
+    void
+    push(const argument_type& x) {
+        panes_[cur_] += x;
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief advances to time t, then inserts x into the current pane;
+     *        windows completed by advancing are discarded
+     *        (use push(t, x, emit) to receive them)
+     */
+    void
+    push(const time_type& t, const argument_type& x) {
+        advance(t);
+        panes_[cur_] += x;
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief advances to time t, then inserts x into the current pane;
+     *        calls emit(windowEnd, windowResult) for each window
+     *        completed by advancing (see advance(now, emit))
+     */
+    template<class Consumer>
+    void
+    push(const time_type& t, const argument_type& x, Consumer&& emit) {
+        advance(t, std::forward<Consumer>(emit));
+        panes_[cur_] += x;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            panes_[cur_] += *first;
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief aggregate of all panes in the current window
+    result_type
+    result() const {
+        auto i = cur_ + 1;
+        if(i >= panes_.size()) i = 0;
+
+        auto res = panes_[i];
+        while(i != cur_) {
+            if(++i >= panes_.size()) i = 0;
+            res.merge(panes_[i]);
+        }
+        return res;
+    }
+    //-----------------------------------------------------
+    /// @brief aggregate of the current (newest) pane only
+    const result_type&
+    current_pane() const noexcept {
+        return panes_[cur_];
+    }
+
+
+private:
+    std::vector<Accumulator> panes_;
+    time_type hop_;
+    time_type paneStart_;
+    size_type cur_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Accumulator, class Time>
+inline decltype(auto)
+result(const hopping_windowed<Accumulator,Time>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
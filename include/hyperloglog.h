@@ -0,0 +1,328 @@
+#ifndef AMLIB_STATISTICS_HYPERLOGLOG_H_
+#define AMLIB_STATISTICS_HYPERLOGLOG_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <type_traits>
+
+#include "hashing.h"
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief estimates the number of distinct values (HyperLogLog++ style;
+ *        Heule, Nunkesser & Hall, 2013)
+ *
+ * @details dense representation: 2^p one-byte registers, each holding the
+ *          maximum number of leading zeros (+1) of the hashes that map to it;
+ *          harmonic-mean estimate, linear counting for small cardinalities;
+ *
+ *          sparse representation (small cardinalities): sorted list of
+ *          (25-bit index, rank) entries plus an unsorted insert buffer;
+ *          estimated with linear counting at precision 25;
+ *          switches to dense once it would use more memory than 2^p bytes;
+ *
+ *          the empirical HLL++ bias-correction tables are not included;
+ *          the relative standard error is about 1.04 / sqrt(2^p)
+ *
+ *****************************************************************************/
+template<class Arg, class Hash = hash64<Arg>>
+class hyperloglog_accumulator
+{
+    static constexpr unsigned sparse_p = 25;
+
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = double;
+    using hasher        = Hash;
+
+
+    //---------------------------------------------------------------
+    /// @param precision  4 <= p <= 18; 2^p registers
+    explicit
+    hyperloglog_accumulator(unsigned precision = 14, const hasher& hash = hasher{}):
+        p_(precision < 4 ? 4 : (precision > 18 ? 18 : precision)),
+        dense_{}, sparse_{}, buffer_{}, hash_(hash)
+    {}
+
+
+    //---------------------------------------------------------------
+    unsigned
+    precision() const noexcept {
+        return p_;
+    }
+    //-----------------------------------------------------
+    std::size_t
+    registers() const noexcept {
+        return std::size_t(1) << p_;
+    }
+    //-----------------------------------------------------
+    bool
+    is_sparse() const noexcept {
+        return dense_.empty();
+    }
+    //-----------------------------------------------------
+    /// @brief heap memory in bytes
+    std::size_t
+    memory_usage() const noexcept {
+        return dense_.capacity() +
+            (sparse_.capacity() + buffer_.capacity()) * sizeof(std::uint32_t);
+    }
+    //-----------------------------------------------------
+    /// @brief standard error relative to the cardinality
+    double
+    relative_error() const noexcept {
+        return 1.04 / std::sqrt(double(registers()));
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        dense_.clear();
+        dense_.shrink_to_fit();
+        sparse_.clear();
+        buffer_.clear();
+    }
+    //-----------------------------------------------------
+    hyperloglog_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    hyperloglog_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        insert_hash(std::uint64_t(hash_(x)));
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            insert_hash(std::uint64_t(hash_(*first)));
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief inserts an already hashed value
+    void
+    insert_hash(std::uint64_t h) {
+        if(dense_.empty()) {
+            buffer_.push_back(sparse_entry(h));
+            if(buffer_.size() >= buffer_limit()) {
+                compact_sparse();
+                if(sparse_too_large()) to_dense();
+            }
+        }
+        else {
+            auto& r = dense_[std::size_t(h >> (64 - p_))];
+            const auto k = rank(h << p_, 64 - p_);
+            if(k > r) r = k;
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief combines with an estimator of the same precision
+    /// @return false, if the precisions differ
+    bool
+    merge(const hyperloglog_accumulator& other) {
+        if(other.p_ != p_) return false;
+
+        if(dense_.empty() && other.dense_.empty()) {
+            buffer_.insert(buffer_.end(), other.sparse_.begin(), other.sparse_.end());
+            buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+            compact_sparse();
+            if(sparse_too_large()) to_dense();
+            return true;
+        }
+        if(dense_.empty()) to_dense();
+
+        if(other.dense_.empty()) {
+            for(auto e : other.sparse_) fold_sparse_entry(e);
+            for(auto e : other.buffer_) fold_sparse_entry(e);
+        }
+        else {
+            //register-wise maximum; plain loop over bytes => vectorizable
+            auto a = dense_.data();
+            const auto b = other.dense_.data();
+            const auto m = dense_.size();
+            for(std::size_t i = 0; i < m; ++i) {
+                a[i] = (b[i] > a[i]) ? b[i] : a[i];
+            }
+        }
+        return true;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief estimated number of distinct values
+    result_type
+    estimate() const {
+        if(dense_.empty()) {
+            //linear counting with 2^25 virtual registers
+            const auto m = double(std::uint64_t(1) << sparse_p);
+            return m * std::log(m / (m - double(sparse_indices())));
+        }
+
+        const auto m = double(registers());
+        double sum = 0;
+        std::size_t zeros = 0;
+        for(auto r : dense_) {
+            sum += std::ldexp(1.0, -int(r));
+            if(r == 0) ++zeros;
+        }
+        const auto e = alpha() * m * m / sum;
+        if(e <= 2.5 * m && zeros > 0) {
+            return m * std::log(m / double(zeros));
+        }
+        return e;
+    }
+    //-----------------------------------------------------
+    result_type
+    result() const {
+        return estimate();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /// @brief position of the first 1-bit in the highest 'bits' bits of x
+    static std::uint8_t
+    rank(std::uint64_t x, unsigned bits) noexcept {
+        std::uint8_t k = 1;
+        for(; k <= bits && !(x & (std::uint64_t(1) << 63)); ++k) x <<= 1;
+        return k > bits ? std::uint8_t(bits + 1) : k;
+    }
+
+    //-----------------------------------------------------
+    double
+    alpha() const noexcept {
+        switch(p_) {
+            case 4: return 0.673;
+            case 5: return 0.697;
+            case 6: return 0.709;
+            default: return 0.7213 / (1.0 + 1.079 / double(registers()));
+        }
+    }
+
+    //-----------------------------------------------------
+    /// @brief 25-bit index | rank of the remaining 39 bits
+    static std::uint32_t
+    sparse_entry(std::uint64_t h) noexcept {
+        const auto idx = std::uint32_t(h >> (64 - sparse_p));
+        return (idx << 6) | rank(h << sparse_p, 64 - sparse_p);
+    }
+    //-----------------------------------------------------
+    void
+    fold_sparse_entry(std::uint32_t e) {
+        const auto idx = e >> 6;
+        const auto sr = std::uint8_t(e & 0x3f);
+        //bits of the 25-bit index below the dense index
+        const auto low = std::uint64_t(idx) << (64 - sparse_p + p_);
+        const auto k = low ? rank(low, sparse_p - p_)
+                           : std::uint8_t(sparse_p - p_ + sr);
+        auto& r = dense_[idx >> (sparse_p - p_)];
+        if(k > r) r = k;
+    }
+
+    //-----------------------------------------------------
+    std::size_t
+    buffer_limit() const noexcept {
+        return std::max(std::size_t(16), registers() / 16);
+    }
+    //-----------------------------------------------------
+    /// @brief number of distinct indices in sorted list and insert buffer;
+    ///        does not modify the estimator (safe for concurrent readers)
+    std::size_t
+    sparse_indices() const {
+        if(buffer_.empty()) return sparse_.size();
+        auto idx = std::vector<std::uint32_t>{};
+        idx.reserve(sparse_.size() + buffer_.size());
+        for(auto e : sparse_) idx.push_back(e >> 6);
+        for(auto e : buffer_) idx.push_back(e >> 6);
+        std::sort(idx.begin(), idx.end());
+        return std::size_t(std::unique(idx.begin(), idx.end()) - idx.begin());
+    }
+    //-----------------------------------------------------
+    /// @brief merges the insert buffer into the sorted list;
+    ///        keeps the maximum rank per index
+    void
+    compact_sparse() {
+        if(buffer_.empty()) return;
+        sparse_.insert(sparse_.end(), buffer_.begin(), buffer_.end());
+        buffer_.clear();
+        //same index => higher rank first
+        std::sort(sparse_.begin(), sparse_.end(),
+            [](std::uint32_t a, std::uint32_t b) {
+                return (a >> 6) < (b >> 6) ||
+                       ((a >> 6) == (b >> 6) && (a & 0x3f) > (b & 0x3f));
+            });
+        sparse_.erase(std::unique(sparse_.begin(), sparse_.end(),
+            [](std::uint32_t a, std::uint32_t b) { return (a >> 6) == (b >> 6); }),
+            sparse_.end());
+    }
+    //-----------------------------------------------------
+    /// @brief sparse list would need more memory than the dense registers
+    bool
+    sparse_too_large() const noexcept {
+        return sparse_.size() * sizeof(std::uint32_t) > registers();
+    }
+    //-----------------------------------------------------
+    void
+    to_dense() {
+        dense_.assign(registers(), 0);
+        for(auto e : sparse_) fold_sparse_entry(e);
+        for(auto e : buffer_) fold_sparse_entry(e);
+        sparse_.clear();
+        sparse_.shrink_to_fit();
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+
+    //---------------------------------------------------------------
+    unsigned p_;
+    std::vector<std::uint8_t> dense_;
+    std::vector<std::uint32_t> sparse_;
+    std::vector<std::uint32_t> buffer_;
+    hasher hash_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Hash>
+inline decltype(auto)
+result(const hyperloglog_accumulator<Arg,Hash>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -63,6 +63,12 @@ public:
             cleared_ = false;
         }
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of a later sample
+    void
+    merge(const initial_value_accumulator& later) {
+        if(!later.cleared_) push(later.cur_);
+    }
 
 
     //---------------------------------------------------------------
@@ -0,0 +1,245 @@
+#ifndef AMLIB_STATISTICS_K_BEST_H_
+#define AMLIB_STATISTICS_K_BEST_H_
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief the k best values seen so far
+ *        (generalization of comparative_accumulator: comp(a,b) == true
+ *        means that a is better than b)
+ *
+ * @details fixed capacity; once full, the worst kept value is the
+ *          threshold and every value that is not better than it is
+ *          rejected with a single comparison;
+ *          small k (<= linear_limit): contiguous array sorted best-first,
+ *          insertion by shifting;
+ *          larger k: binary heap with the worst value on top, O(log k);
+ *          payloads (e.g. std::pair<latency,id>) are ordered by the
+ *          comparator alone
+ *
+ ****************************************************************************/
+template<
+    class Arg,
+    class Comparator
+>
+class k_best_accumulator
+{
+public:
+    //---------------------------------------------------------------
+    using comparator    = Comparator;
+    using argument_type = Arg;
+    using result_type   = std::vector<Arg>;
+    using size_type     = std::size_t;
+
+    static constexpr size_type linear_limit = 32;
+
+
+    //---------------------------------------------------------------
+    explicit
+    k_best_accumulator(size_type k = 10, const comparator& comp = comparator{}):
+        k_(k > 0 ? k : 1), vals_{}, comp_(comp)
+    {
+        vals_.reserve(k_);
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    capacity() const noexcept {
+        return k_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of kept values
+    size_type
+    size() const noexcept {
+        return vals_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return vals_.empty();
+    }
+    //-----------------------------------------------------
+    bool
+    full() const noexcept {
+        return vals_.size() >= k_;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        vals_.clear();
+    }
+    //-----------------------------------------------------
+    k_best_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    k_best_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        if(!full()) {
+            insert(x);
+        }
+        else if(comp_(x, worst())) {
+            replace_worst(x);
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last && !full(); ++first) {
+            insert(*first);
+        }
+        if(first == last) return;
+
+        //position of the threshold is fixed from here on
+        const auto& thr = linear() ? vals_.back() : vals_.front();
+        for(; first != last; ++first) {
+            if(comp_(*first, thr)) replace_worst(*first);
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const k_best_accumulator& other) {
+        if(&other == this) {
+            const auto v = vals_;
+            push(v.begin(), v.end());
+        } else {
+            push(other.vals_.begin(), other.vals_.end());
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief k-th best value (the threshold for new values once full);
+    ///        must not be empty
+    const argument_type&
+    worst() const {
+        return linear() ? vals_.back() : vals_.front();
+    }
+    //-----------------------------------------------------
+    /// @brief must not be empty
+    const argument_type&
+    best() const {
+        return linear() ? vals_.front()
+                        : *std::min_element(vals_.begin(), vals_.end(), comp_);
+    }
+    //-----------------------------------------------------
+    /// @brief kept values, best first
+    result_type
+    result() const {
+        if(linear()) return vals_;
+        auto res = vals_;
+        std::sort_heap(res.begin(), res.end(), comp_);
+        return res;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    bool
+    linear() const noexcept {
+        return k_ <= linear_limit;
+    }
+    //-----------------------------------------------------
+    /// @brief insertion into a non-full container
+    void
+    insert(const argument_type& x) {
+        if(linear()) {
+            //sorted best-first; equal values keep insertion order
+            vals_.insert(std::upper_bound(vals_.begin(), vals_.end(), x, comp_), x);
+        } else {
+            vals_.push_back(x);
+            std::push_heap(vals_.begin(), vals_.end(), comp_);
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief x must be better than worst()
+    void
+    replace_worst(const argument_type& x) {
+        if(linear()) {
+            //shift worse values one slot back
+            auto i = vals_.size() - 1;
+            for(; i > 0 && comp_(x, vals_[i-1]); --i) {
+                vals_[i] = std::move(vals_[i-1]);
+            }
+            vals_[i] = x;
+        } else {
+            std::pop_heap(vals_.begin(), vals_.end(), comp_);
+            vals_.back() = x;
+            std::push_heap(vals_.begin(), vals_.end(), comp_);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    size_type k_;
+    std::vector<argument_type> vals_;
+    comparator comp_;
+};
+
+
+template<class Arg, class Comp>
+constexpr typename k_best_accumulator<Arg,Comp>::size_type
+k_best_accumulator<Arg,Comp>::linear_limit;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *
+ *****************************************************************************/
+template<class Arg>
+using top_k_accumulator = k_best_accumulator<Arg,std::greater<Arg>>;
+
+template<class Arg>
+using bottom_k_accumulator = k_best_accumulator<Arg,std::less<Arg>>;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Comp>
+inline decltype(auto)
+result(const k_best_accumulator<Arg,Comp>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -0,0 +1,713 @@
+#ifndef AMLIB_STATISTICS_KLL_H_
+#define AMLIB_STATISTICS_KLL_H_
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief streaming quantile estimation with a KLL sketch
+ *        (Karnin, Lang & Liberty, 2016)
+ *
+ * @details hierarchy of compactors; an item on level h represents 2^h samples;
+ *          a full level is sorted and every other item (random offset)
+ *          is promoted to the next level;
+ *          the rank error is bounded with high probability
+ *          (see normalized_rank_error) and does not depend on the
+ *          value distribution;
+ *          all levels live in one contiguous arena
+ *          (free space at the front, level 0 grows downwards);
+ *          the random bits come from a seeded generator,
+ *          so equal inputs always produce equal sketches
+ *
+ * @tparam Arg  value type (must be trivially copyable for read/write)
+ *
+ *****************************************************************************/
+template<class Arg, class Comparator = std::less<Arg>>
+class kll_accumulator
+{
+    using level_t = std::uint32_t;
+
+public:
+    //---------------------------------------------------------------
+    using comparator    = Comparator;
+    using argument_type = Arg;
+    using result_type   = Arg;
+    using size_type     = std::uint_least64_t;
+
+    static constexpr std::uint16_t default_k = 200;
+    static constexpr std::uint64_t default_seed = 0x2545f4914f6cdd1dull;
+
+
+    //---------------------------------------------------------------
+    /**
+     * @param k     accuracy parameter (>= 8); the rank error is
+     *              about 1.65% for k = 200 (99% confidence)
+     * @param seed  random seed for the compactors
+     */
+    explicit
+    kll_accumulator(std::uint16_t k = default_k,
+                    std::uint64_t seed = default_seed,
+                    const comparator& comp = comparator{})
+    :
+        k_(k < min_k ? min_k : k),
+        n_(0), seed_(seed ? seed : default_seed), rnd_(seed_),
+        items_{}, levels_{}, min_{}, max_{},
+        sorted_{}, sortedValid_(false),
+        comp_(comp)
+    {
+        init();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief normalized rank error for a given k (99% confidence)
+    static double
+    normalized_rank_error(std::uint16_t k, bool doubleSided = true) noexcept {
+        using std::pow;
+        return doubleSided ? 2.446 / pow(double(k), 0.9433)
+                           : 2.296 / pow(double(k), 0.9723);
+    }
+    //-----------------------------------------------------
+    double
+    normalized_rank_error(bool doubleSided = true) const noexcept {
+        return normalized_rank_error(k_, doubleSided);
+    }
+
+
+    //---------------------------------------------------------------
+    std::uint16_t
+    k() const noexcept {
+        return k_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples
+    size_type
+    size() const noexcept {
+        return n_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (n_ < 1);
+    }
+    //-----------------------------------------------------
+    /// @brief number of retained items
+    std::size_t
+    retained() const noexcept {
+        return items_.size() - levels_.front();
+    }
+    //-----------------------------------------------------
+    std::size_t
+    num_levels() const noexcept {
+        return levels_.size() - 1;
+    }
+    //-----------------------------------------------------
+    /// @brief heap + object memory in bytes
+    std::size_t
+    memory_usage() const noexcept {
+        return sizeof(*this)
+            + items_.capacity() * sizeof(argument_type)
+            + levels_.capacity() * sizeof(level_t)
+            + sorted_.capacity() * sizeof(std::pair<argument_type,size_type>);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        n_ = 0;
+        rnd_ = seed_;
+        init();
+    }
+    //-----------------------------------------------------
+    kll_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    kll_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        update_min_max(x);
+        if(levels_[0] == 0) compress_while_updating();
+        items_[--levels_[0]] = x;
+        ++n_;
+        sortedValid_ = false;
+    }
+    //-----------------------------------------------------
+    /// @brief copies [first,last) into free space in chunks
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        while(first != last) {
+            if(levels_[0] == 0) compress_while_updating();
+            auto i = levels_[0];
+            for(; i > 0 && first != last; ++first) {
+                update_min_max(*first);
+                items_[--i] = *first;
+            }
+            n_ += levels_[0] - i;
+            levels_[0] = i;
+        }
+        sortedValid_ = false;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const kll_accumulator& other) {
+        if(other.empty()) return;
+        if(empty()) {
+            min_ = other.min_;
+            max_ = other.max_;
+        } else {
+            if(comp_(other.min_, min_)) min_ = other.min_;
+            if(comp_(max_, other.max_)) max_ = other.max_;
+        }
+
+        const auto nl = std::max(num_levels(), other.num_levels());
+        auto lv = std::vector<std::vector<argument_type>>(nl);
+        for(std::size_t h = 0; h < nl; ++h) {
+            auto& l = lv[h];
+            if(h < num_levels()) {
+                l.insert(l.end(), items_.begin() + levels_[h],
+                                  items_.begin() + levels_[h+1]);
+            }
+            if(h < other.num_levels()) {
+                const auto m = l.size();
+                l.insert(l.end(), other.items_.begin() + other.levels_[h],
+                                  other.items_.begin() + other.levels_[h+1]);
+                if(h > 0) {
+                    std::inplace_merge(l.begin(), l.begin() + m, l.end(), comp_);
+                }
+            }
+        }
+        n_ += other.n_;
+        general_compress(lv);
+        sortedValid_ = false;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief undefined if empty
+    const result_type&
+    min() const noexcept {
+        return min_;
+    }
+    //-----------------------------------------------------
+    /// @brief undefined if empty
+    const result_type&
+    max() const noexcept {
+        return max_;
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief builds the sorted view of all retained items that quantile
+     *        and rank queries work on;
+     *        const queries never modify the sketch: without a prepared view
+     *        they build a temporary one, so calling prepare() first makes
+     *        repeated queries cheaper
+     */
+    void
+    prepare() {
+        if(sortedValid_) return;
+        sorted_ = sorted_view();
+        sortedValid_ = true;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief approximate q-quantile (0 <= q <= 1) by nearest rank;
+    ///        undefined if empty
+    result_type
+    quantile(double q) const {
+        if(!(q > 0)) return min_;
+        if(!(q < 1)) return max_;
+        return sortedValid_ ? quantile(sorted_, q) : quantile(sorted_view(), q);
+    }
+    //-----------------------------------------------------
+    /// @brief approximate fraction of samples that are <= x
+    double
+    rank(const argument_type& x) const {
+        if(empty()) return 0;
+        return sortedValid_ ? rank(sorted_, x) : rank(sorted_view(), x);
+    }
+    //-----------------------------------------------------
+    result_type
+    median() const {
+        return quantile(0.5);
+    }
+    //-----------------------------------------------------
+    result_type
+    result() const {
+        return median();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief writes the sketch in a compact binary format
+    void
+    write(std::ostream& os) const {
+        static_assert(std::is_trivially_copyable<argument_type>::value,
+            "kll_accumulator::write requires a trivially copyable value type");
+
+        write_pod(os, magic);
+        write_pod(os, std::uint32_t(sizeof(argument_type)));
+        write_pod(os, k_);
+        write_pod(os, n_);
+        write_pod(os, seed_);
+        write_pod(os, rnd_);
+        write_pod(os, min_);
+        write_pod(os, max_);
+        write_pod(os, std::uint32_t(num_levels()));
+        for(std::size_t h = 0; h < num_levels(); ++h) {
+            write_pod(os, level_t(levels_[h+1] - levels_[h]));
+        }
+        const auto beg = items_.data() + levels_[0];
+        os.write(reinterpret_cast<const char*>(beg),
+                 std::streamsize(retained() * sizeof(argument_type)));
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief reads a sketch written by 'write';
+     *        returns false (and leaves the sketch empty) on failure
+     * @details validates the input before anything is committed:
+     *          level sizes are only allocated as far as the stream actually
+     *          holds items, the level weights must add up to the sample count,
+     *          all levels above 0 must be sorted and all items must lie
+     *          within [min,max]
+     */
+    bool
+    read(std::istream& is) {
+        static_assert(std::is_trivially_copyable<argument_type>::value,
+            "kll_accumulator::read requires a trivially copyable value type");
+
+        if(!read_checked(is)) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+
+private:
+    static constexpr std::uint16_t min_k = 8;
+    static constexpr level_t min_capacity = 8;
+    static constexpr std::uint32_t magic = 0x4b4c4c31;   //"KLL1"
+
+
+    //---------------------------------------------------------------
+    template<class T>
+    static void
+    write_pod(std::ostream& os, const T& x) {
+        os.write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+    //-----------------------------------------------------
+    template<class T>
+    static void
+    read_pod(std::istream& is, T& x) {
+        is.read(reinterpret_cast<char*>(&x), sizeof(T));
+    }
+
+
+    //---------------------------------------------------------------
+    bool
+    read_checked(std::istream& is) {
+        std::uint32_t mg = 0, vs = 0, nl = 0;
+        read_pod(is, mg);
+        read_pod(is, vs);
+        if(!is || mg != magic || vs != sizeof(argument_type)) return false;
+
+        std::uint16_t k = 0;
+        size_type n = 0;
+        std::uint64_t seed = 0, rnd = 0;
+        argument_type mn{}, mx{};
+        read_pod(is, k);
+        read_pod(is, n);
+        read_pod(is, seed);
+        read_pod(is, rnd);
+        read_pod(is, mn);
+        read_pod(is, mx);
+        read_pod(is, nl);
+        if(!is || k < min_k || seed == 0 || rnd == 0 || nl < 1 || nl > 64) {
+            return false;
+        }
+
+        auto sizes = std::vector<level_t>(nl);
+        for(auto& sz : sizes) read_pod(is, sz);
+        if(!is) return false;
+
+        //sum of weights (size * 2^h) must equal n; guards against overflow
+        size_type weight = 0;
+        for(std::size_t h = 0; h < nl; ++h) {
+            const auto sz = size_type(sizes[h]);
+            if(sz > 0 && (h >= 64 || sz > ((~size_type(0) - weight) >> h))) {
+                return false;
+            }
+            weight += sz << h;
+        }
+        if(weight != n) return false;
+
+        //read in chunks => memory is bounded by the actual stream length
+        constexpr std::size_t chunk = 4096;
+        auto lv = std::vector<std::vector<argument_type>>(nl);
+        for(std::size_t h = 0; h < nl; ++h) {
+            auto& l = lv[h];
+            while(l.size() < sizes[h]) {
+                const auto old = l.size();
+                const auto m = std::min(chunk, std::size_t(sizes[h] - old));
+                l.resize(old + m);
+                is.read(reinterpret_cast<char*>(l.data() + old),
+                        std::streamsize(m * sizeof(argument_type)));
+                if(!is) return false;
+            }
+            if(h > 0 && !std::is_sorted(l.begin(), l.end(), comp_)) return false;
+            for(const auto& x : l) {
+                if(comp_(x, mn) || comp_(mx, x)) return false;
+            }
+        }
+
+        //commit
+        k_ = k;
+        n_ = n;
+        seed_ = seed;
+        rnd_ = rnd;
+        min_ = mn;
+        max_ = mx;
+        rebuild(lv);
+        sorted_.clear();
+        sortedValid_ = false;
+        return true;
+    }
+
+    //-----------------------------------------------------
+    void
+    init() {
+        items_.assign(k_, argument_type{});
+        levels_.assign(2, level_t(k_));
+        sorted_.clear();
+        sortedValid_ = false;
+    }
+
+    //-----------------------------------------------------
+    void
+    update_min_max(const argument_type& x) {
+        if(n_ < 1) {
+            min_ = x;
+            max_ = x;
+        } else {
+            if(comp_(x, min_)) min_ = x;
+            if(comp_(max_, x)) max_ = x;
+        }
+    }
+
+    //-----------------------------------------------------
+    bool
+    random_bit() noexcept {
+        rnd_ ^= rnd_ << 13;
+        rnd_ ^= rnd_ >> 7;
+        rnd_ ^= rnd_ << 17;
+        return (rnd_ & 1) != 0;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief capacity of level h in a sketch with 'numLevels' levels:
+    ///        k * (2/3)^depth, at least min_capacity
+    level_t
+    level_capacity(std::size_t h, std::size_t numLevels) const noexcept {
+        const auto depth = numLevels - h - 1;
+        //(2/3)^depth underflows to 0 for very large depths
+        const auto c = depth < 64
+            ? level_t(std::ceil(double(k_) * std::pow(2.0/3.0, double(depth))))
+            : level_t(0);
+        return (c > min_capacity) ? c : min_capacity;
+    }
+    //-----------------------------------------------------
+    std::size_t
+    total_capacity(std::size_t numLevels) const noexcept {
+        std::size_t c = 0;
+        for(std::size_t h = 0; h < numLevels; ++h) {
+            c += level_capacity(h, numLevels);
+        }
+        return c;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief compacts the lowest full level into the level above it
+    void
+    compress_while_updating() {
+        auto nl = num_levels();
+        std::size_t h = 0;
+        while(h + 1 < nl &&
+              (levels_[h+1] - levels_[h]) < level_capacity(h, nl))
+        {
+            ++h;
+        }
+        if(h + 1 == nl) {
+            add_empty_top_level();
+            ++nl;
+        }
+
+        const auto rawBeg = levels_[h];
+        const auto rawEnd = levels_[h+1];
+        const auto popAbove = levels_[h+2] - rawEnd;
+        const auto rawPop = rawEnd - rawBeg;
+        const bool odd = (rawPop & 1) != 0;
+        const auto adjBeg = odd ? rawBeg + 1 : rawBeg;
+        const auto adjPop = rawPop - (odd ? 1 : 0);
+        const auto halfAdj = adjPop / 2;
+
+        auto beg = items_.begin();
+        if(h == 0) std::sort(beg + adjBeg, beg + adjBeg + adjPop, comp_);
+
+        if(popAbove == 0) {
+            halve_up(adjBeg, adjPop);
+        }
+        else {
+            halve_down(adjBeg, adjPop);
+            //merge in place; the output never overtakes the unread input
+            merge_into(adjBeg, halfAdj, rawEnd, popAbove, adjBeg + halfAdj);
+        }
+
+        levels_[h+1] -= halfAdj;
+        if(odd) {
+            levels_[h] = levels_[h+1] - 1;
+            items_[levels_[h]] = items_[rawBeg];
+        } else {
+            levels_[h] = levels_[h+1];
+        }
+
+        //move lower levels up to close the gap
+        if(h > 0) {
+            const auto shift = levels_[h] - rawBeg;
+            std::copy_backward(beg + levels_[0], beg + rawBeg, beg + levels_[h]);
+            for(std::size_t i = 0; i < h; ++i) levels_[i] += shift;
+        }
+    }
+
+    //-----------------------------------------------------
+    void
+    add_empty_top_level() {
+        const auto nl = num_levels();
+        const auto delta = total_capacity(nl + 1) - total_capacity(nl);
+        items_.insert(items_.begin(), delta, argument_type{});
+        for(auto& l : levels_) l += level_t(delta);
+        levels_.push_back(levels_.back());
+    }
+
+    //-----------------------------------------------------
+    /// @brief keeps every other item of the sorted range [b,b+n)
+    ///        in its upper half
+    void
+    halve_up(std::size_t b, std::size_t n) {
+        const auto half = n / 2;
+        auto j = b + n - 1 - (random_bit() ? 1 : 0);
+        for(auto i = b + n; i > b + half; --i, j -= 2) {
+            items_[i-1] = items_[j];
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief keeps every other item of the sorted range [b,b+n)
+    ///        in its lower half
+    void
+    halve_down(std::size_t b, std::size_t n) {
+        const auto half = n / 2;
+        auto j = b + (random_bit() ? 1 : 0);
+        for(auto i = b; i < b + half; ++i, j += 2) {
+            items_[i] = items_[j];
+        }
+    }
+    //-----------------------------------------------------
+    void
+    merge_into(std::size_t a, std::size_t na,
+               std::size_t b, std::size_t nb, std::size_t out)
+    {
+        const auto ae = a + na;
+        const auto be = b + nb;
+        while(a < ae && b < be) {
+            if(comp_(items_[b], items_[a])) items_[out++] = items_[b++];
+            else                            items_[out++] = items_[a++];
+        }
+        while(a < ae) items_[out++] = items_[a++];
+        while(b < be) items_[out++] = items_[b++];
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief compacts separate levels until they fit, then rebuilds the arena
+    void
+    general_compress(std::vector<std::vector<argument_type>>& lv) {
+        for(bool compacted = true; compacted; ) {
+            compacted = false;
+            for(std::size_t h = 0; h < lv.size(); ++h) {
+                if(lv[h].size() < level_capacity(h, lv.size())) continue;
+                if(h + 1 == lv.size()) lv.emplace_back();
+                compact(lv[h], lv[h+1], h == 0);
+                compacted = true;
+            }
+        }
+
+        rebuild(lv);
+    }
+    //-----------------------------------------------------
+    /// @brief lays out separate levels in the arena
+    void
+    rebuild(const std::vector<std::vector<argument_type>>& lv) {
+        const auto nl = lv.size();
+        std::size_t total = 0;
+        for(const auto& l : lv) total += l.size();
+        items_.assign(std::max(total, total_capacity(nl)), argument_type{});
+        levels_.assign(nl + 1, level_t(0));
+        auto pos = items_.size();
+        levels_[nl] = level_t(pos);
+        for(auto h = nl; h > 0; --h) {
+            const auto& l = lv[h-1];
+            pos -= l.size();
+            std::copy(l.begin(), l.end(), items_.begin() + pos);
+            levels_[h-1] = level_t(pos);
+        }
+    }
+    //-----------------------------------------------------
+    void
+    compact(std::vector<argument_type>& lo, std::vector<argument_type>& hi,
+            bool unsorted)
+    {
+        if(unsorted) std::sort(lo.begin(), lo.end(), comp_);
+        const bool odd = (lo.size() & 1) != 0;
+        const std::size_t b = odd ? 1 : 0;
+        const auto half = (lo.size() - b) / 2;
+
+        auto promoted = std::vector<argument_type>{};
+        promoted.reserve(half);
+        for(auto i = b + (random_bit() ? 1 : 0); i < lo.size(); i += 2) {
+            promoted.push_back(lo[i]);
+        }
+        lo.resize(b);
+
+        const auto m = hi.size();
+        hi.insert(hi.end(), promoted.begin(), promoted.end());
+        std::inplace_merge(hi.begin(), hi.begin() + m, hi.end(), comp_);
+    }
+
+
+    //---------------------------------------------------------------
+    using sorted_view_t = std::vector<std::pair<argument_type,size_type>>;
+
+    /// @brief all retained items sorted by value with cumulative weights
+    sorted_view_t
+    sorted_view() const {
+        auto view = sorted_view_t{};
+        view.reserve(retained());
+        for(std::size_t h = 0; h < num_levels(); ++h) {
+            const auto w = size_type(1) << h;
+            for(auto i = levels_[h]; i < levels_[h+1]; ++i) {
+                view.emplace_back(items_[i], w);
+            }
+        }
+        std::sort(view.begin(), view.end(),
+            [this](const std::pair<argument_type,size_type>& a,
+                   const std::pair<argument_type,size_type>& b) {
+                return comp_(a.first, b.first);
+            });
+        size_type cum = 0;
+        for(auto& e : view) {
+            cum += e.second;
+            e.second = cum;
+        }
+        return view;
+    }
+    //-----------------------------------------------------
+    result_type
+    quantile(const sorted_view_t& view, double q) const {
+        const auto r = size_type(std::ceil(q * double(n_)));
+        const auto i = std::lower_bound(view.begin(), view.end(), r,
+            [](const std::pair<argument_type,size_type>& e, size_type x) {
+                return e.second < x;
+            });
+        return (i != view.end()) ? i->first : max_;
+    }
+    //-----------------------------------------------------
+    double
+    rank(const sorted_view_t& view, const argument_type& x) const {
+        const auto i = std::upper_bound(view.begin(), view.end(), x,
+            [this](const argument_type& v, const std::pair<argument_type,size_type>& e) {
+                return comp_(v, e.first);
+            });
+        if(i == view.begin()) return 0;
+        return double((i-1)->second) / double(n_);
+    }
+
+
+    //---------------------------------------------------------------
+    std::uint16_t k_;
+    size_type n_;
+    std::uint64_t seed_;
+    std::uint64_t rnd_;
+    std::vector<argument_type> items_;
+    std::vector<level_t> levels_;
+    argument_type min_;
+    argument_type max_;
+    sorted_view_t sorted_;
+    bool sortedValid_;
+    comparator comp_;
+};
+
+template<class Arg, class Comp>
+constexpr std::uint16_t kll_accumulator<Arg,Comp>::default_k;
+template<class Arg, class Comp>
+constexpr std::uint64_t kll_accumulator<Arg,Comp>::default_seed;
+template<class Arg, class Comp>
+constexpr std::uint16_t kll_accumulator<Arg,Comp>::min_k;
+template<class Arg, class Comp>
+constexpr std::uint32_t kll_accumulator<Arg,Comp>::min_capacity;
+template<class Arg, class Comp>
+constexpr std::uint32_t kll_accumulator<Arg,Comp>::magic;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Comp>
+inline decltype(auto)
+result(const kll_accumulator<Arg,Comp>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
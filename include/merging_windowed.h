@@ -0,0 +1,171 @@
+#ifndef AMLIB_STATISTICS_MERGING_WINDOWED_H_
+#define AMLIB_STATISTICS_MERGING_WINDOWED_H_
+
+#include <vector>
+#include <cstddef>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief accumulator decorator that restricts an accumulator to the n latest
+ *        values; works with any accumulator that provides
+ *        a.merge(b) ('a' followed by the later sample 'b'),
+ *        no undo operation (-=) is required
+ *
+ * @details two-stacks sliding window aggregation:
+ *          new values go onto a 'back' stack with one running aggregate;
+ *          the 'front' stack holds the oldest values, each entry
+ *          aggregating itself and all newer front entries;
+ *          when the front stack runs empty, the back stack is flipped over
+ *          => amortized O(1) push and at most one merge per query
+ *
+ ****************************************************************************/
+template<class Accumulator>
+class merging_windowed
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = typename Accumulator::argument_type;
+    using result_type   = Accumulator;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    merging_windowed(size_type windowSize = 10):
+        front_{}, back_{}, backAgg_{},
+        windowSize_(windowSize > 0 ? windowSize : 1)
+    {
+        front_.reserve(windowSize_);
+        back_.reserve(windowSize_);
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    window_size() const noexcept {
+        return windowSize_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return front_.size() + back_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return front_.empty() && back_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        front_.clear();
+        back_.clear();
+        backAgg_ = Accumulator{};
+    }
+    //-----------------------------------------------------
+    merging_windowed&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    merging_windowed&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        if(size() >= windowSize_) pop();
+        back_.push_back(x);
+        backAgg_ += x;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief removes the oldest value from the window
+    void
+    pop() {
+        if(front_.empty()) {
+            if(back_.empty()) return;
+            flip();
+        }
+        front_.pop_back();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief aggregate of all values in the window
+    result_type
+    result() const {
+        if(front_.empty()) return backAgg_;
+        if(back_.empty()) return front_.back();
+
+        auto res = front_.back();
+        res.merge(backAgg_);
+        return res;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    void
+    flip() {
+        //newest value ends up at the bottom of the front stack
+        for(auto i = back_.size(); i > 0; --i) {
+            auto a = Accumulator{};
+            a += back_[i-1];
+            if(!front_.empty()) a.merge(front_.back());
+            front_.push_back(std::move(a));
+        }
+        back_.clear();
+        backAgg_ = Accumulator{};
+    }
+
+
+    //---------------------------------------------------------------
+    std::vector<Accumulator> front_;
+    std::vector<argument_type> back_;
+    Accumulator backAgg_;
+    size_type windowSize_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Accumulator>
+inline decltype(auto)
+result(const merging_windowed<Accumulator>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -55,6 +55,14 @@ public:
         max_ += x;
         moments_ += x;
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const min_max_moments_accumulator& other) {
+        min_.merge(other.min_);
+        max_.merge(other.max_);
+        moments_.merge(other.moments_);
+    }
 
 
     //---------------------------------------------------------------
@@ -269,6 +277,14 @@ public:
         max_ -= x;
         moments_ -= x;
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const reversible_min_max_moments_accumulator& other) {
+        min_.merge(other.min_);
+        max_.merge(other.max_);
+        moments_.merge(other.moments_);
+    }
 
 
     //---------------------------------------------------------------
@@ -50,6 +50,19 @@ make_fp(T&& x) {
     return std::forward<T>(x);
 }
 
+
+///@brief true, if It is a (multi-pass) forward iterator
+template<class It, class = void>
+struct is_forward_iterator : std::false_type {};
+
+template<class It>
+struct is_forward_iterator<It, std::enable_if_t<std::is_base_of<
+    std::forward_iterator_tag,
+    typename std::iterator_traits<It>::iterator_category>::value>>
+:
+    std::true_type
+{};
+
 } // namespace detail
 
 
@@ -473,6 +486,20 @@ public:
     pop() {
         --n_;
     }
+    //-----------------------------------------------------
+    /// @brief [first,last) is traversed once by every moment level
+    template<class ForwardIterator, class = std::enable_if_t<
+        detail::is_forward_iterator<ForwardIterator>::value>>
+    void
+    push(ForwardIterator first, ForwardIterator last) {
+        using std::distance;
+        n_ += size_type(distance(first, last));
+    }
+    //-----------------------------------------------------
+    void
+    merge(const moments_accumulator& other) {
+        n_ += other.n_;
+    }
 
 
 protected:
@@ -569,6 +596,28 @@ public:
         base_t_::pop();
         sum_ -= x;
     }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); one loop per moment that adds the
+    ///        values in sequence order (no reordering of floating-point sums)
+    template<class ForwardIterator, class = std::enable_if_t<
+        detail::is_forward_iterator<ForwardIterator>::value>>
+    void
+    push(ForwardIterator first, ForwardIterator last) {
+        base_t_::push(first, last);
+        auto s = result_type(0);
+        for(; first != last; ++first) {
+            const result_type x = *first;
+            s += x;
+        }
+        sum_ += s;
+    }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const this_t_& other) {
+        base_t_::merge(other);
+        sum_ += other.sum_;
+    }
 
 
     //---------------------------------------------------------------
@@ -683,6 +732,28 @@ public:
         base_t_::pop(x);
         sum2_ -= x*x;
     }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); one loop per moment that adds the
+    ///        values in sequence order (no reordering of floating-point sums)
+    template<class ForwardIterator, class = std::enable_if_t<
+        detail::is_forward_iterator<ForwardIterator>::value>>
+    void
+    push(ForwardIterator first, ForwardIterator last) {
+        base_t_::push(first, last);
+        auto s = result_type(0);
+        for(; first != last; ++first) {
+            const result_type x = *first;
+            s += x*x;
+        }
+        sum2_ += s;
+    }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const this_t_& other) {
+        base_t_::merge(other);
+        sum2_ += other.sum2_;
+    }
 
 
     //---------------------------------------------------------------
@@ -808,6 +879,28 @@ public:
         base_t_::push(x);
         sum3_ += x*x*x;
     }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); one loop per moment that adds the
+    ///        values in sequence order (no reordering of floating-point sums)
+    template<class ForwardIterator, class = std::enable_if_t<
+        detail::is_forward_iterator<ForwardIterator>::value>>
+    void
+    push(ForwardIterator first, ForwardIterator last) {
+        base_t_::push(first, last);
+        auto s = result_type(0);
+        for(; first != last; ++first) {
+            const result_type x = *first;
+            s += x*x*x;
+        }
+        sum3_ += s;
+    }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const this_t_& other) {
+        base_t_::merge(other);
+        sum3_ += other.sum3_;
+    }
 
 
     //---------------------------------------------------------------
@@ -956,6 +1049,28 @@ public:
         x *= x;
         sum4_ += x;
     }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); one loop per moment that adds the
+    ///        values in sequence order (no reordering of floating-point sums)
+    template<class ForwardIterator, class = std::enable_if_t<
+        detail::is_forward_iterator<ForwardIterator>::value>>
+    void
+    push(ForwardIterator first, ForwardIterator last) {
+        base_t_::push(first, last);
+        auto s = result_type(0);
+        for(; first != last; ++first) {
+            const result_type x = *first;
+            s += x*x*x*x;
+        }
+        sum4_ += s;
+    }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const this_t_& other) {
+        base_t_::merge(other);
+        sum4_ += other.sum4_;
+    }
 
 
     //---------------------------------------------------------------
@@ -0,0 +1,149 @@
+#ifndef AMLIB_STATISTICS_MULTI_WINDOWED_H_
+#define AMLIB_STATISTICS_MULTI_WINDOWED_H_
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+#include "ring_buffer.h"
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief accumulator decorator that maintains one reversible accumulator
+ *        per window size (e.g. the latest 100, 1000 and 10000 samples)
+ *
+ * @details all windows are nested and share one ring buffer that holds
+ *          as many samples as the largest window;
+ *          each accumulator evicts the sample at its own offset
+ *          from the newest end of the buffer
+ *
+ ****************************************************************************/
+template<class Accumulator>
+class multi_windowed
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = typename Accumulator::argument_type;
+    using result_type   = Accumulator;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    /// @brief window sizes are sorted in ascending order; 0s are ignored
+    explicit
+    multi_windowed(std::vector<size_type> windowSizes):
+        accs_{}, sizes_(std::move(windowSizes)), buffer_{}
+    {
+        sizes_.erase(std::remove(sizes_.begin(), sizes_.end(), size_type(0)),
+                     sizes_.end());
+        if(sizes_.empty()) sizes_.push_back(1);
+        std::sort(sizes_.begin(), sizes_.end());
+
+        accs_.resize(sizes_.size());
+        buffer_.reserve(sizes_.back());
+    }
+    //-----------------------------------------------------
+    multi_windowed(std::initializer_list<size_type> windowSizes):
+        multi_windowed(std::vector<size_type>(windowSizes))
+    {}
+
+
+    //---------------------------------------------------------------
+    /// @brief number of windows
+    size_type
+    windows() const noexcept {
+        return sizes_.size();
+    }
+    //-----------------------------------------------------
+    /// @brief size of the i-th smallest window
+    size_type
+    window_size(size_type i) const noexcept {
+        return sizes_[i];
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples currently in the i-th smallest window
+    size_type
+    size(size_type i) const noexcept {
+        return (buffer_.size() < sizes_[i]) ? buffer_.size() : sizes_[i];
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return buffer_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        for(auto& a : accs_) a.clear();
+        buffer_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    multi_windowed&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        const auto n = buffer_.size();
+        for(size_type i = 0; i < sizes_.size(); ++i) {
+            if(n >= sizes_[i]) accs_[i] -= buffer_[n - sizes_[i]];
+            accs_[i] += x;
+        }
+        if(n >= sizes_.back()) buffer_.pop_front();
+        buffer_.push_back(x);
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    const argument_type&
+    top() const {
+        return buffer_.back();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief statistics of the i-th smallest window
+    const result_type&
+    result(size_type i) const noexcept {
+        return accs_[i];
+    }
+    //-----------------------------------------------------
+    const result_type&
+    operator [] (size_type i) const noexcept {
+        return accs_[i];
+    }
+
+
+private:
+    std::vector<Accumulator> accs_;
+    std::vector<size_type> sizes_;
+    am::ring_buffer<argument_type> buffer_;
+};
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -6,6 +6,9 @@
 #include <cstdint>
 #include <numeric>
 #include <algorithm>
+#include <type_traits>
+
+#include "normalized_view.h"
 
 
 namespace am {
@@ -98,32 +101,45 @@ public:
     //---------------------------------------------------------------
     void
     insert(const argument_type& x) {
-        const auto binsBeg = bins_.begin();
-        const auto binsEnd = bins_.end();
-
-        if((binsBeg != binsEnd) && (x >= binsBeg->first))
-        {
-            auto it = std::lower_bound(binsBeg, binsEnd, value_type{x,0},
-                [](const value_type& a, const value_type& b) {
-                    return a.first < b.first;
-                });
-
-            if(it != binsEnd) {
-                if(it->first > x) {
-                    --it;
-                }
-                ++(it->second);
-            }
-        }
+        const auto i = index(x);
+        if(i < bins_.size()) ++(bins_[i].second);
     }
     //-----------------------------------------------------
-    template<class InputIterator>
+    /// @brief increases the count of x's bin by 'weight'
+    void
+    insert(const argument_type& x, const count_type& weight) {
+        const auto i = index(x);
+        if(i < bins_.size()) bins_[i].second += weight;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
     void
     insert(InputIterator begin, InputIterator end) {
         for(; begin != end; ++begin) {
             insert(*begin);
         }
     }
+    //-----------------------------------------------------
+    /// @brief inserts values [begin,end) with weights starting at 'weights'
+    template<class InputIterator, class WeightIterator>
+    void
+    insert(InputIterator begin, InputIterator end, WeightIterator weights) {
+        for(; begin != end; ++begin, ++weights) {
+            insert(*begin, *weights);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief multiplies all counts by 'factor'
+    template<class Factor>
+    void
+    scale(const Factor& factor) {
+        for(auto& x : bins_) {
+            x.second *= factor;
+        }
+    }
 
 
     //---------------------------------------------------------------
@@ -132,7 +148,7 @@ public:
     operator () (const argument_type& x) const {
         //find x's bin and return current count
         const auto it = find(x);
-        return (it != end()) ? it->second : value_type(0);
+        return (it != end()) ? it->second : count_type(0);
     }
     //-----------------------------------------------------
     bool
@@ -141,17 +157,30 @@ public:
         return (find(x) != end());
     }
     //-----------------------------------------------------
-    iterator
+    const_iterator
     find(const argument_type& x) const
     {
-        if((begin() == end()) || (x < begin()->first)) {
-            return end();
-        }
+        return begin() + index(x);
+    }
+    //-----------------------------------------------------
+    /// @brief index of the bin that x falls in; size() if there is none
+    size_type
+    index(const argument_type& x) const
+    {
+        const auto binsBeg = bins_.begin();
+        const auto binsEnd = bins_.end();
+
+        if((binsBeg == binsEnd) || (x < binsBeg->first)) return bins_.size();
 
-        return std::lower_bound(begin(), end(), value_type{x,0},
+        auto it = std::lower_bound(binsBeg, binsEnd, value_type{x,0},
             [](const value_type& a, const value_type& b) {
                 return a.first < b.first;
             });
+
+        if(it == binsEnd) return bins_.size();
+        if(it->first > x) --it;
+
+        return size_type(it - binsBeg);
     }
 
 
@@ -327,6 +356,99 @@ print(Ostream& os, const nonuniform_histogram<Argument,Count>& h)
 }
 
 
+
+
+//-------------------------------------------------------------------
+/**
+ * @brief writes the relative frequency of each bin to 'out'
+ *        no memory is allocated
+ */
+template<class Argument, class Count, class OutputIterator>
+OutputIterator
+relative_frequencies(const nonuniform_histogram<Argument,Count>& h,
+                     OutputIterator out)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    const auto tot = static_cast<fp_t>(h.total());
+    const auto rn = (tot != fp_t(0)) ? (fp_t(1) / tot) : fp_t(0);
+
+    for(const auto& x : h) {
+        *out = static_cast<fp_t>(x.second) * rn;
+        ++out;
+    }
+    return out;
+}
+
+//---------------------------------------------------------
+template<class Argument, class Count>
+auto
+relative_frequencies(const nonuniform_histogram<Argument,Count>& h)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    auto res = std::vector<fp_t>(h.size());
+    relative_frequencies(h, res.begin());
+
+    return res;
+}
+
+//---------------------------------------------------------
+/**
+ * @brief lazy view of the relative bin frequencies of 'h'
+ *        'h' must outlive the view; changes of bin counts are reflected
+ *        as long as the total is not changed
+ */
+template<class Argument, class Count>
+auto
+normalized(const nonuniform_histogram<Argument,Count>& h)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+    using view_t = normalized_view<
+        typename nonuniform_histogram<Argument,Count>::const_iterator,
+        detail::second_projection, fp_t>;
+
+    return view_t{h.begin(), h.end(), static_cast<fp_t>(h.total())};
+}
+
+
+//-------------------------------------------------------------------
+/**
+ * @brief estimates the q-quantile (0 <= q <= 1) of the values inserted into
+ *        'h' assuming that values are uniformly distributed within each bin;
+ *        the last bin has no upper bound and yields its lower bound
+ */
+template<class Argument, class Count>
+auto
+quantile(const nonuniform_histogram<Argument,Count>& h, double q)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    if(h.empty()) return fp_t(0);
+
+    const auto tot = static_cast<fp_t>(h.total());
+    if(!(tot > fp_t(0))) return static_cast<fp_t>(h[0].first);
+
+    if(q < 0) q = 0;
+    if(q > 1) q = 1;
+    const auto target = fp_t(q) * tot;
+
+    const auto n = h.size();
+    auto cum = fp_t(0);
+    for(std::size_t i = 0; i < n; ++i) {
+        const auto c = static_cast<fp_t>(h[i].second);
+        if(c > fp_t(0) && cum + c >= target) {
+            const auto lo = static_cast<fp_t>(h[i].first);
+            if(i + 1 >= n) return lo;
+            const auto hi = static_cast<fp_t>(h[i+1].first);
+            return lo + ((target - cum) / c) * (hi - lo);
+        }
+        cum += c;
+    }
+    return static_cast<fp_t>(h[n-1].first);
+}
+
+
 } //namespace stat
 }  // namespace am
 
@@ -0,0 +1,182 @@
+#ifndef AMLIB_STATISTICS_NORMALIZED_VIEW_H_
+#define AMLIB_STATISTICS_NORMALIZED_VIEW_H_
+
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief read-only view of a range of counts
+ *        that yields each count divided by a fixed total
+ *        (no memory is allocated, frequencies are computed on access)
+ *
+ * @tparam Iterator    random access iterator over bins
+ * @tparam Projection  maps a bin (*Iterator) to its count
+ * @tparam Fp          floating point type of the frequencies
+ *
+ *****************************************************************************/
+template<class Iterator, class Projection, class Fp = double>
+class normalized_view
+{
+public:
+    //---------------------------------------------------------------
+    using value_type = Fp;
+    using size_type  = std::size_t;
+
+
+    //---------------------------------------------------------------
+    class const_iterator
+    {
+        friend class normalized_view;
+
+        const_iterator(Iterator it, Projection proj, value_type rn):
+            it_(std::move(it)), proj_(std::move(proj)), rn_(rn)
+        {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Fp;
+        using difference_type =
+            typename std::iterator_traits<Iterator>::difference_type;
+        using reference = value_type;
+
+        /// @brief frequencies are computed on access => pointer is a proxy
+        class pointer {
+            friend class const_iterator;
+            explicit pointer(value_type x): x_(x) {}
+            value_type x_;
+        public:
+            const value_type& operator * () const noexcept { return x_; }
+            const value_type* operator -> () const noexcept { return &x_; }
+        };
+
+        const_iterator() = default;
+
+        value_type
+        operator * () const {
+            return value_type(proj_(*it_)) * rn_;
+        }
+        pointer
+        operator -> () const {
+            return pointer{**this};
+        }
+        value_type
+        operator [] (difference_type i) const {
+            return value_type(proj_(it_[i])) * rn_;
+        }
+
+        const_iterator& operator ++ () { ++it_; return *this; }
+        const_iterator& operator -- () { --it_; return *this; }
+        const_iterator operator ++ (int) { auto old = *this; ++it_; return old; }
+        const_iterator operator -- (int) { auto old = *this; --it_; return old; }
+
+        const_iterator& operator += (difference_type n) { it_ += n; return *this; }
+        const_iterator& operator -= (difference_type n) { it_ -= n; return *this; }
+
+        const_iterator
+        operator + (difference_type n) const { auto r = *this; return r += n; }
+        const_iterator
+        operator - (difference_type n) const { auto r = *this; return r -= n; }
+
+        difference_type
+        operator - (const const_iterator& o) const { return it_ - o.it_; }
+
+        bool operator == (const const_iterator& o) const { return it_ == o.it_; }
+        bool operator != (const const_iterator& o) const { return it_ != o.it_; }
+        bool operator <  (const const_iterator& o) const { return it_ <  o.it_; }
+        bool operator >  (const const_iterator& o) const { return it_ >  o.it_; }
+        bool operator <= (const const_iterator& o) const { return it_ <= o.it_; }
+        bool operator >= (const const_iterator& o) const { return it_ >= o.it_; }
+
+        friend const_iterator
+        operator + (difference_type n, const const_iterator& i) { return i + n; }
+
+    private:
+        Iterator it_;
+        Projection proj_;
+        value_type rn_;
+    };
+
+    using iterator = const_iterator;
+
+
+    //---------------------------------------------------------------
+    normalized_view(Iterator first, Iterator last, value_type total,
+                    Projection proj = Projection{})
+    :
+        first_(std::move(first)), last_(std::move(last)),
+        proj_(std::move(proj)),
+        rn_((total != value_type(0)) ? (value_type(1) / total) : value_type(0))
+    {}
+
+
+    //---------------------------------------------------------------
+    value_type
+    operator [] (size_type i) const {
+        return value_type(proj_(first_[i])) * rn_;
+    }
+
+    //-----------------------------------------------------
+    size_type
+    size() const noexcept {
+        using std::distance;
+        return size_type(distance(first_, last_));
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return first_ == last_;
+    }
+
+
+    //---------------------------------------------------------------
+    const_iterator
+    begin() const {
+        return const_iterator{first_, proj_, rn_};
+    }
+    //-----------------------------------------------------
+    const_iterator
+    end() const {
+        return const_iterator{last_, proj_, rn_};
+    }
+
+
+private:
+    Iterator first_;
+    Iterator last_;
+    Projection proj_;
+    value_type rn_;
+};
+
+
+
+namespace detail {
+
+//-------------------------------------------------------------------
+struct identity_projection {
+    template<class T>
+    constexpr const T& operator () (const T& x) const noexcept { return x; }
+};
+
+//-------------------------------------------------------------------
+struct second_projection {
+    template<class T>
+    constexpr decltype(auto) operator () (const T& x) const noexcept {
+        return (x.second);
+    }
+};
+
+} // namespace detail
+
+
+} //namespace stat
+}  // namespace am
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef AMLIB_STATISTICS_P2_QUANTILE_H_
+#define AMLIB_STATISTICS_P2_QUANTILE_H_
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <ratio>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief constant-memory estimation of a fixed set of quantiles with the
+ *        (extended) P² algorithm (Jain & Chlamtac, 1985; Raatikainen, 1987)
+ *
+ * @details m quantiles are tracked with 2m+3 markers (min, max, the quantiles
+ *          and the midpoints between them); each sample moves the marker
+ *          positions by at most one and adjusts the marker heights
+ *          with piecewise-parabolic interpolation;
+ *          O(m) per sample, no allocation;
+ *          results are exact until 2m+3 samples have been seen
+ *
+ * @tparam Quantiles  std::ratio values in (0,1), ascending
+ *
+ *****************************************************************************/
+template<class Arg, class... Quantiles>
+class p2_quantile_accumulator
+{
+    static_assert(sizeof...(Quantiles) > 0,
+        "p2_quantile_accumulator: at least one quantile required");
+
+    static constexpr std::size_t m_ = sizeof...(Quantiles);
+    static constexpr std::size_t markers_ = 2*m_ + 3;
+
+    using real_t = std::common_type_t<double,Arg>;
+
+    //---------------------------------------------------------------
+    static constexpr real_t
+    prob(std::size_t j) noexcept {
+        const real_t p[] = { real_t(Quantiles::num) / real_t(Quantiles::den)... };
+        return p[j];
+    }
+    //-----------------------------------------------------
+    static constexpr bool
+    valid_quantiles() noexcept {
+        for(std::size_t j = 0; j < m_; ++j) {
+            if(!(prob(j) > 0) || !(prob(j) < 1)) return false;
+            if(j > 0 && !(prob(j-1) < prob(j))) return false;
+        }
+        return true;
+    }
+    static_assert(valid_quantiles(),
+        "p2_quantile_accumulator: quantiles must be ascending and in (0,1)");
+
+    //-----------------------------------------------------
+    /// @brief target probability of marker i
+    static constexpr real_t
+    marker_prob(std::size_t i) noexcept {
+        return (i == 0) ? real_t(0)
+             : (i == markers_ - 1) ? real_t(1)
+             : (i % 2 == 0) ? prob(i/2 - 1)
+             : (((i == 1) ? real_t(0) : prob(i/2 - 1)) +
+                ((i == markers_ - 2) ? real_t(1) : prob(i/2))) / 2;
+    }
+
+
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = real_t;
+    using size_type     = std::uint_least64_t;
+
+
+    //---------------------------------------------------------------
+    constexpr
+    p2_quantile_accumulator() noexcept:
+        h_{}, pos_{}, n_(0)
+    {}
+
+
+    //---------------------------------------------------------------
+    static constexpr std::size_t
+    num_quantiles() noexcept {
+        return m_;
+    }
+    //-----------------------------------------------------
+    /// @brief probability of the i-th tracked quantile
+    static constexpr real_t
+    probability(std::size_t i) noexcept {
+        return prob(i);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() noexcept {
+        n_ = 0;
+    }
+    //-----------------------------------------------------
+    p2_quantile_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    p2_quantile_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        const auto v = real_t(x);
+
+        //collect the first samples in sorted order
+        if(n_ < markers_) {
+            auto i = std::size_t(n_);
+            for(; i > 0 && v < h_[i-1]; --i) h_[i] = h_[i-1];
+            h_[i] = v;
+            ++n_;
+            if(n_ == markers_) {
+                for(std::size_t j = 0; j < markers_; ++j) pos_[j] = real_t(j + 1);
+            }
+            return;
+        }
+
+        //find cell k with h[k] <= v < h[k+1]; extend extremes
+        std::size_t k = 0;
+        if(v < h_[0]) {
+            h_[0] = v;
+        }
+        else if(!(v < h_[markers_-1])) {
+            h_[markers_-1] = v;
+            k = markers_ - 2;
+        }
+        else {
+            while(!(v < h_[k+1])) ++k;
+        }
+        for(std::size_t i = k + 1; i < markers_; ++i) pos_[i] += 1;
+        ++n_;
+
+        //adjust interior markers
+        const auto nm1 = real_t(n_ - 1);
+        for(std::size_t i = 1; i + 1 < markers_; ++i) {
+            const auto d = (1 + marker_prob(i) * nm1) - pos_[i];
+            if( (d >=  1 && pos_[i+1] - pos_[i] >  1) ||
+                (d <= -1 && pos_[i-1] - pos_[i] < -1) )
+            {
+                const real_t s = (d > 0) ? 1 : -1;
+                const auto hp = parabolic(i, s);
+                if(h_[i-1] < hp && hp < h_[i+1]) {
+                    h_[i] = hp;
+                } else {
+                    const auto j = (s > 0) ? i + 1 : i - 1;
+                    h_[i] += s * (h_[j] - h_[i]) / (pos_[j] - pos_[i]);
+                }
+                pos_[i] += s;
+            }
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    size() const noexcept {
+        return n_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (n_ < 1);
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief estimate of the i-th tracked quantile; 0 if empty
+    result_type
+    quantile(std::size_t i) const noexcept {
+        if(n_ < 1) return result_type(0);
+        if(n_ < markers_) {
+            //exact (nearest rank) from the sorted initial samples
+            auto r = std::size_t(prob(i) * real_t(n_));
+            if(real_t(r) < prob(i) * real_t(n_)) ++r;
+            return h_[(r > 0) ? r - 1 : 0];
+        }
+        return h_[2*i + 2];
+    }
+    //-----------------------------------------------------
+    template<std::size_t i>
+    result_type
+    quantile() const noexcept {
+        static_assert(i < m_, "p2_quantile_accumulator: quantile index out of range");
+        return quantile(i);
+    }
+    //-----------------------------------------------------
+    std::array<result_type,m_>
+    quantiles() const noexcept {
+        std::array<result_type,m_> res;
+        for(std::size_t i = 0; i < m_; ++i) res[i] = quantile(i);
+        return res;
+    }
+    //-----------------------------------------------------
+    result_type
+    min() const noexcept {
+        return (n_ < 1) ? result_type(0) : h_[0];
+    }
+    //-----------------------------------------------------
+    result_type
+    max() const noexcept {
+        return (n_ < 1) ? result_type(0)
+             : h_[(n_ < markers_) ? std::size_t(n_ - 1) : markers_ - 1];
+    }
+    //-----------------------------------------------------
+    /// @brief estimate of the first tracked quantile
+    result_type
+    result() const noexcept {
+        return quantile(0);
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    real_t
+    parabolic(std::size_t i, real_t s) const noexcept {
+        const auto np = pos_[i+1], n = pos_[i], nm = pos_[i-1];
+        return h_[i] + s / (np - nm) * (
+            (n - nm + s) * (h_[i+1] - h_[i]) / (np - n) +
+            (np - n - s) * (h_[i] - h_[i-1]) / (n - nm) );
+    }
+
+
+    //---------------------------------------------------------------
+    std::array<real_t,markers_> h_;
+    std::array<real_t,markers_> pos_;
+    size_type n_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *
+ *****************************************************************************/
+template<class Arg>
+using p2_median_accumulator = p2_quantile_accumulator<Arg,std::ratio<1,2>>;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class... Qs>
+inline decltype(auto)
+result(const p2_quantile_accumulator<Arg,Qs...>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -0,0 +1,369 @@
+#ifndef AMLIB_STATISTICS_QUANTILE_H_
+#define AMLIB_STATISTICS_QUANTILE_H_
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <thread>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "moments.h"
+
+
+namespace am {
+namespace stat {
+
+namespace detail {
+
+//-------------------------------------------------------------------
+/// @brief position of the q-quantile in a sorted range of size n:
+///        (n-1)*q = k + frac
+inline std::pair<std::size_t,double>
+quantile_position(std::size_t n, double q) noexcept
+{
+    if(!(q > 0) || n < 2) return {0, 0.0};
+    if(!(q < 1)) return {n-1, 0.0};
+    const auto h = double(n - 1) * q;
+    const auto k = std::size_t(h);
+    return (k + 1 < n) ? std::make_pair(k, h - double(k))
+                       : std::make_pair(n-1, 0.0);
+}
+
+//-------------------------------------------------------------------
+template<class T>
+inline auto
+interpolate(const T& a, const T& b, double frac)
+{
+    using fp_t = decltype(make_fp(a));
+    return (frac > 0) ? fp_t(make_fp(a) + (make_fp(b) - make_fp(a)) * frac)
+                      : fp_t(make_fp(a));
+}
+
+//-------------------------------------------------------------------
+/**
+ * @brief places the elements with ranks [rfirst,rlast) (sorted, unique)
+ *        at their sorted positions in [first,last);
+ *        each partition step splits both the range and the rank list
+ */
+template<class RandomAccessIterator, class RankIterator>
+void
+multi_select(RandomAccessIterator first, RandomAccessIterator last,
+             std::size_t offset, RankIterator rfirst, RankIterator rlast)
+{
+    while(rfirst != rlast && first != last) {
+        const auto rmid = rfirst + (rlast - rfirst) / 2;
+        const auto nth = first + (*rmid - offset);
+        std::nth_element(first, nth, last);
+
+        //left part recursively, right part iteratively
+        multi_select(first, nth, offset, rfirst, rmid);
+        offset = *rmid + 1;
+        first = nth + 1;
+        rfirst = rmid + 1;
+    }
+}
+
+//-------------------------------------------------------------------
+template<class RandomAccessIterator, class QIterator, class OutIterator>
+OutIterator
+quantiles_inplace(RandomAccessIterator first, RandomAccessIterator last,
+                  QIterator qfirst, QIterator qlast, OutIterator out)
+{
+    using std::distance;
+    const auto n = std::size_t(distance(first, last));
+
+    auto ranks = std::vector<std::size_t>{};
+    for(auto q = qfirst; q != qlast; ++q) {
+        const auto p = quantile_position(n, *q);
+        ranks.push_back(p.first);
+        if(p.second > 0) ranks.push_back(p.first + 1);
+    }
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+    if(n > 0) multi_select(first, last, 0, ranks.begin(), ranks.end());
+
+    for(auto q = qfirst; q != qlast; ++q, ++out) {
+        if(n < 1) {
+            *out = decltype(interpolate(*first, *first, 0.0))(0);
+            continue;
+        }
+        const auto p = quantile_position(n, *q);
+        const auto& a = first[p.first];
+        *out = (p.second > 0) ? interpolate(a, first[p.first + 1], p.second)
+                              : interpolate(a, a, 0.0);
+    }
+    return out;
+}
+
+//-------------------------------------------------------------------
+/// @brief joins all joinable threads on destruction
+class thread_joiner
+{
+public:
+    explicit
+    thread_joiner(std::vector<std::thread>& threads) noexcept:
+        threads_(threads)
+    {}
+
+    ~thread_joiner() {
+        for(auto& t : threads_) {
+            if(t.joinable()) t.join();
+        }
+    }
+
+private:
+    std::vector<std::thread>& threads_;
+};
+
+} // namespace detail
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief q-quantile (0 <= q <= 1) of a range; linear interpolation between
+ *        the two closest ranks ((n-1)*q, like R type 7 / numpy default);
+ *        uses selection (O(n)) instead of sorting;
+ *        the *_inplace variants reorder the input instead of copying it
+ *
+ *****************************************************************************/
+template<class RandomAccessIterator>
+inline auto
+quantile_inplace(RandomAccessIterator first, RandomAccessIterator last, double q)
+{
+    using std::distance;
+    using fp_t = decltype(detail::make_fp(*first));
+
+    const auto n = std::size_t(distance(first, last));
+    if(n < 1) return fp_t(0);
+
+    const auto p = detail::quantile_position(n, q);
+    const auto nth = first + p.first;
+    std::nth_element(first, nth, last);
+    if(!(p.second > 0)) return fp_t(detail::make_fp(*nth));
+
+    //next rank = smallest value right of nth
+    const auto next = std::min_element(nth + 1, last);
+    return fp_t(detail::interpolate(*nth, *next, p.second));
+}
+
+//---------------------------------------------------------
+template<class InputIterator>
+inline auto
+quantile(InputIterator first, InputIterator last, double q)
+{
+    using val_t = typename std::iterator_traits<InputIterator>::value_type;
+    auto v = std::vector<val_t>(first, last);
+    return quantile_inplace(v.begin(), v.end(), q);
+}
+
+//---------------------------------------------------------
+template<class RandomAccessIterator>
+inline auto
+median_inplace(RandomAccessIterator first, RandomAccessIterator last)
+{
+    return quantile_inplace(first, last, 0.5);
+}
+
+//---------------------------------------------------------
+template<class InputIterator>
+inline auto
+median(InputIterator first, InputIterator last)
+{
+    return quantile(first, last, 0.5);
+}
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief several quantiles of a range at once; writes one value per q to 'out';
+ *        all required ranks are selected in one shared recursive partition
+ *        (each partition step splits both the range and the list of ranks)
+ *
+ *****************************************************************************/
+template<class RandomAccessIterator, class QIterator, class OutIterator>
+inline OutIterator
+quantiles_inplace(RandomAccessIterator first, RandomAccessIterator last,
+                  QIterator qfirst, QIterator qlast, OutIterator out)
+{
+    return detail::quantiles_inplace(first, last, qfirst, qlast, out);
+}
+
+//---------------------------------------------------------
+template<class InputIterator, class QIterator, class OutIterator>
+inline OutIterator
+quantiles(InputIterator first, InputIterator last,
+          QIterator qfirst, QIterator qlast, OutIterator out)
+{
+    using val_t = typename std::iterator_traits<InputIterator>::value_type;
+    auto v = std::vector<val_t>(first, last);
+    return detail::quantiles_inplace(v.begin(), v.end(), qfirst, qlast, out);
+}
+
+//---------------------------------------------------------
+template<class InputIterator>
+inline auto
+quantiles(InputIterator first, InputIterator last, std::initializer_list<double> qs)
+{
+    using fp_t = decltype(detail::make_fp(*first));
+    auto res = std::vector<fp_t>{};
+    res.reserve(qs.size());
+    quantiles(first, last, qs.begin(), qs.end(), std::back_inserter(res));
+    return res;
+}
+
+//---------------------------------------------------------
+template<class RandomAccessIterator>
+inline auto
+quantiles_inplace(RandomAccessIterator first, RandomAccessIterator last,
+                  std::initializer_list<double> qs)
+{
+    using fp_t = decltype(detail::make_fp(*first));
+    auto res = std::vector<fp_t>{};
+    res.reserve(qs.size());
+    detail::quantiles_inplace(first, last, qs.begin(), qs.end(),
+                              std::back_inserter(res));
+    return res;
+}
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief q-quantile of a large range using several threads;
+ *        the input is not modified
+ *
+ * @details a sorted random sample yields two values that bracket the
+ *          required ranks with high probability; the threads count the
+ *          values below the bracket and collect the values inside it
+ *          (one pass over n/threads values each);
+ *          the final selection runs on the small candidate set;
+ *          falls back to sequential selection for small ranges,
+ *          if the bracket misses or if a worker thread cannot be
+ *          started or fails
+ *
+ *****************************************************************************/
+template<class RandomAccessIterator>
+auto
+quantile_parallel(RandomAccessIterator first, RandomAccessIterator last,
+                  double q, std::size_t threads = std::thread::hardware_concurrency())
+{
+    using std::distance;
+    using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+    const auto n = std::size_t(distance(first, last));
+    if(threads < 2 || n < (std::size_t(1) << 16)) return quantile(first, last, q);
+
+    const auto p = detail::quantile_position(n, q);
+    const auto kLo = p.first;
+    const auto kHi = (p.second > 0) ? kLo + 1 : kLo;
+
+    //random sample of size ~ sqrt(n)
+    const auto m = std::size_t(std::sqrt(double(n))) + 1;
+    auto sample = std::vector<val_t>{};
+    sample.reserve(m);
+    std::uint_least64_t rnd = 0x9e3779b97f4a7c15ull;
+    for(std::size_t i = 0; i < m; ++i) {
+        rnd = rnd * 6364136223846793005ull + 1442695040888963407ull;
+        sample.push_back(first[std::size_t(rnd >> 11) % n]);
+    }
+    std::sort(sample.begin(), sample.end());
+
+    //bracket: +- 3 standard deviations of the sample rank
+    const auto margin = 3 * std::size_t(std::sqrt(double(m))) + 2;
+    const auto sLo = std::size_t(double(kLo) / double(n) * double(m));
+    const auto sHi = std::size_t(double(kHi) / double(n) * double(m));
+    const bool hasLo = sLo > margin;
+    const bool hasHi = sHi + margin < m;
+    const auto& lo = sample[hasLo ? sLo - margin : 0];
+    const auto& hi = sample[hasHi ? sHi + margin : m-1];
+
+    //count values below, collect values in [lo,hi]
+    auto below = std::vector<std::size_t>(threads, 0);
+    auto cands = std::vector<std::vector<val_t>>(threads);
+    auto failed = std::vector<char>(threads, 0);
+    bool startFailed = false;
+    const auto chunk = (n + threads - 1) / threads;
+    {
+        auto workers = std::vector<std::thread>{};
+        workers.reserve(threads);
+        //started threads are joined even if starting another one fails
+        detail::thread_joiner joiner{workers};
+        try {
+            for(std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    try {
+                        const auto b = std::min(n, t * chunk);
+                        const auto e = std::min(n, b + chunk);
+                        auto& c = cands[t];
+                        std::size_t cnt = 0;
+                        for(auto i = first + b, ie = first + e; i != ie; ++i) {
+                            if(hasLo && *i < lo) ++cnt;
+                            else if(!hasHi || !(hi < *i)) c.push_back(*i);
+                        }
+                        below[t] = cnt;
+                    }
+                    catch(...) {
+                        failed[t] = 1;
+                    }
+                });
+            }
+        }
+        catch(...) {
+            startFailed = true;
+        }
+    }
+    //thread could not be started or ran out of memory => sequential selection
+    if(startFailed ||
+       std::find(failed.begin(), failed.end(), char(1)) != failed.end())
+    {
+        return quantile(first, last, q);
+    }
+
+    std::size_t nBelow = 0;
+    std::size_t nCands = 0;
+    for(std::size_t t = 0; t < threads; ++t) {
+        nBelow += below[t];
+        nCands += cands[t].size();
+    }
+    //bracket missed => sequential selection
+    if(nBelow > kLo || nBelow + nCands <= kHi) return quantile(first, last, q);
+
+    auto& c = cands.front();
+    c.reserve(nCands);
+    for(std::size_t t = 1; t < threads; ++t) {
+        c.insert(c.end(), cands[t].begin(), cands[t].end());
+    }
+    const auto nth = c.begin() + (kLo - nBelow);
+    std::nth_element(c.begin(), nth, c.end());
+    if(kHi == kLo) return decltype(quantile(first, last, q))(detail::make_fp(*nth));
+
+    const auto next = std::min_element(nth + 1, c.end());
+    return decltype(quantile(first, last, q))(
+        detail::interpolate(*nth, *next, p.second));
+}
+
+//---------------------------------------------------------
+template<class RandomAccessIterator>
+inline auto
+median_parallel(RandomAccessIterator first, RandomAccessIterator last,
+                std::size_t threads = std::thread::hardware_concurrency())
+{
+    return quantile_parallel(first, last, 0.5, threads);
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef AMLIB_STATISTICS_REBIN_H_
+#define AMLIB_STATISTICS_REBIN_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include "uniform_histogram.h"
+#include "nonuniform_histogram.h"
+
+
+namespace am {
+namespace stat {
+
+namespace detail {
+
+
+/*************************************************************************//***
+ *
+ * @brief distributes the counts of a uniform histogram over target bins
+ *        [edge(j), edge(j+1)), j = 0..m-1 in one linear pass
+ *
+ *        floating-point target counts: each source bin is split
+ *        proportionally to its overlap with the target bins
+ *        integral target counts: each source bin is added in full to
+ *        the target bin that contains its center
+ *
+ *****************************************************************************/
+template<class Argument, class Bins, class Edge, class Add>
+void
+redistribute(const uniform_histogram<Argument,Bins>& src,
+             std::size_t m, Edge edge, Add add, std::true_type /*proportional*/)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    const auto w = fp_t(src.bin_width());
+    if(m < 1 || !(w > 0)) return;
+
+    auto j = std::size_t(0);
+
+    for(std::size_t i = 0; i < src.size(); ++i) {
+        if(src[i] == 0) continue;
+
+        const auto lo = fp_t(src.min()) + fp_t(i) * w;
+        const auto hi = lo + w;
+
+        while(j < m && fp_t(edge(j+1)) <= lo) ++j;
+
+        for(auto k = j; k < m && fp_t(edge(k)) < hi; ++k) {
+            const auto a = (fp_t(edge(k)) > lo) ? fp_t(edge(k)) : lo;
+            const auto b = (fp_t(edge(k+1)) < hi) ? fp_t(edge(k+1)) : hi;
+            if(b > a) add(k, fp_t(src[i]) * ((b - a) / w));
+        }
+    }
+}
+
+//---------------------------------------------------------
+template<class Argument, class Bins, class Edge, class Add>
+void
+redistribute(const uniform_histogram<Argument,Bins>& src,
+             std::size_t m, Edge edge, Add add, std::false_type /*by center*/)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    const auto w = fp_t(src.bin_width());
+    if(m < 1 || !(w > 0)) return;
+
+    auto j = std::size_t(0);
+
+    for(std::size_t i = 0; i < src.size(); ++i) {
+        if(src[i] == 0) continue;
+
+        const auto c = fp_t(src.min()) + (fp_t(i) + fp_t(0.5)) * w;
+
+        if(c < fp_t(edge(0))) continue;
+        while(j < m && fp_t(edge(j+1)) <= c) ++j;
+        if(j >= m) break;
+
+        add(j, src[i]);
+    }
+}
+
+
+} // namespace detail
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief merges each group of k adjacent bins of 'src' into one bin of 'dst'
+ *        'dst' is reset to cover the range of 'src' with k times the
+ *        bin width of 'src'; its bin storage is reused
+ *
+ *****************************************************************************/
+template<class Argument, class Bins1, class Bins2>
+void
+merge_bins(const uniform_histogram<Argument,Bins1>& src,
+           std::size_t k,
+           uniform_histogram<Argument,Bins2>& dst)
+{
+    using count_t = typename uniform_histogram<Argument,Bins2>::value_type;
+
+    if(k < 1) k = 1;
+    const auto n = (src.size() + k - 1) / k;
+    const auto w = src.bin_width() * Argument(k);
+
+    dst.reset(src.min(), src.min() + w * Argument(n), w);
+
+    for(std::size_t i = 0; i < src.size(); ++i) {
+        dst[i / k] += count_t(src[i]);
+    }
+}
+
+
+
+/*************************************************************************//***
+ *
+ * @brief distributes the counts of 'src' over the bins of 'dst'
+ *        'dst' keeps its range and bin width, existing counts are cleared
+ *        (see detail::redistribute for integral vs. floating-point counts)
+ *
+ *****************************************************************************/
+template<class Argument, class Bins1, class Bins2>
+void
+project(const uniform_histogram<Argument,Bins1>& src,
+        uniform_histogram<Argument,Bins2>& dst)
+{
+    using count_t = typename uniform_histogram<Argument,Bins2>::value_type;
+
+    dst.clear();
+
+    const auto lo = dst.min();
+    const auto w  = dst.bin_width();
+
+    detail::redistribute(src, dst.size(),
+        [&](std::size_t j) { return lo + w * Argument(j); },
+        [&](std::size_t j, auto c) { dst[j] += count_t(c); },
+        std::is_floating_point<count_t>{});
+}
+
+//---------------------------------------------------------
+/**
+ * @brief distributes the counts of 'src' over the bins of 'dst'
+ *        'dst' keeps its bin boundaries, existing counts are cleared;
+ *        bin j of 'dst' covers [dst[j].first, dst[j+1].first)
+ */
+template<class Argument, class Bins, class Count>
+void
+project(const uniform_histogram<Argument,Bins>& src,
+        nonuniform_histogram<Argument,Count>& dst)
+{
+    dst.clear();
+    if(dst.empty()) return;
+
+    const auto m = dst.size();
+
+    detail::redistribute(src, m,
+        [&](std::size_t j) { return dst[(j < m) ? j : (m-1)].first; },
+        [&](std::size_t j, auto c) { dst[j].second += Count(c); },
+        std::is_floating_point<Count>{});
+}
+
+
+
+/*************************************************************************//***
+ *
+ * @brief re-bins 'src' into 'dst' with a new bin width
+ *        'dst' is reset to start at src.min() and to cover all of 'src';
+ *        its bin storage is reused
+ *
+ *****************************************************************************/
+template<class Argument, class Bins1, class Bins2>
+void
+rebin(const uniform_histogram<Argument,Bins1>& src,
+      const Argument& binWidth,
+      uniform_histogram<Argument,Bins2>& dst)
+{
+    if(!(binWidth > 0)) {
+        dst.reset(src.min(), src.min(), binWidth);
+        return;
+    }
+
+    auto n = static_cast<std::size_t>((src.max() - src.min()) / binWidth);
+    if(src.min() + binWidth * Argument(n) < src.max()) ++n;
+
+    dst.reset(src.min(), src.min() + binWidth * Argument(n), binWidth);
+
+    project(src, dst);
+}
+
+
+} //namespace stat
+}  // namespace am
+
+#endif
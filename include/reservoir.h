@@ -0,0 +1,494 @@
+#ifndef AMLIB_STATISTICS_RESERVOIR_H_
+#define AMLIB_STATISTICS_RESERVOIR_H_
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief uniform random sample of (at most) k values of a stream
+ *        (Algorithm L; Li, 1994)
+ *
+ * @details after the reservoir is full, the number of values to skip until
+ *          the next replacement is drawn from a geometric distribution,
+ *          so most pushes only decrement a counter and the number of
+ *          random draws is O(k log(n/k));
+ *          the range push jumps over whole blocks of skipped values;
+ *          reproducible for a given seed
+ *
+ *****************************************************************************/
+template<
+    class Arg,
+    class URNG = std::mt19937_64
+>
+class reservoir_accumulator
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = std::vector<Arg>;
+    using size_type     = std::uint_least64_t;
+    using random_engine = URNG;
+
+
+    //---------------------------------------------------------------
+    explicit
+    reservoir_accumulator(std::size_t k = 100,
+                          typename URNG::result_type seed = URNG::default_seed)
+    :
+        k_(k > 0 ? k : 1), n_(0), skip_(0), w_(1),
+        sample_{}, urng_(seed)
+    {
+        sample_.reserve(k_);
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief maximum sample size
+    std::size_t
+    capacity() const noexcept {
+        return k_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of values seen
+    size_type
+    size() const noexcept {
+        return n_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (n_ < 1);
+    }
+    //-----------------------------------------------------
+    void
+    seed(typename URNG::result_type s) {
+        urng_.seed(s);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        n_ = 0;
+        skip_ = 0;
+        w_ = 1;
+        sample_.clear();
+    }
+    //-----------------------------------------------------
+    reservoir_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    reservoir_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        ++n_;
+        if(sample_.size() < k_) {
+            sample_.push_back(x);
+            if(sample_.size() == k_) start_skipping();
+        }
+        else if(skip_ > 0) {
+            --skip_;
+        }
+        else {
+            replace(x);
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        using std::distance;
+        using std::advance;
+        using cat = typename std::iterator_traits<InputIterator>::iterator_category;
+        constexpr bool randomAccess =
+            std::is_base_of<std::random_access_iterator_tag,cat>::value;
+
+        for(; first != last && sample_.size() < k_; ++first) push(*first);
+
+        while(first != last) {
+            //jump over the skipped values
+            if(randomAccess) {
+                const auto rem = size_type(distance(first, last));
+                if(rem <= skip_) {
+                    skip_ -= rem;
+                    n_ += rem;
+                    return;
+                }
+                advance(first, typename std::iterator_traits<
+                                   InputIterator>::difference_type(skip_));
+                n_ += skip_;
+                skip_ = 0;
+            } else {
+                for(; skip_ > 0 && first != last; --skip_, ++first) ++n_;
+                if(first == last) return;
+            }
+            ++n_;
+            replace(*first);
+            ++first;
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief combines with the sample of another (disjoint) stream;
+     *        the result is a uniform sample of the concatenated stream
+     *        (values are drawn without replacement from both reservoirs
+     *        with probabilities proportional to the remaining stream sizes)
+     * @return false, if the capacities differ
+     */
+    bool
+    merge(const reservoir_accumulator& other) {
+        if(other.k_ != k_) return false;
+        if(other.n_ < 1) return true;
+        if(n_ < 1) {
+            const auto rng = urng_;
+            *this = other;
+            urng_ = rng;
+            return true;
+        }
+
+        auto a = sample_;
+        auto b = other.sample_;
+        auto na = n_;
+        auto nb = other.n_;
+        const auto total = n_ + other.n_;
+        const auto m = std::size_t(std::min(size_type(k_), total));
+
+        sample_.clear();
+        while(sample_.size() < m) {
+            auto& src = (uniform_index(na + nb) < na) ? a : b;
+            auto& cnt = (&src == &a) ? na : nb;
+            const auto i = std::size_t(uniform_index(src.size()));
+            sample_.push_back(src[i]);
+            src[i] = src.back();
+            src.pop_back();
+            --cnt;
+        }
+        n_ = total;
+
+        if(sample_.size() == k_) {
+            //threshold of Algorithm L after n values: k-th smallest of
+            //n uniform keys ~ Beta(k, n-k+1)
+            auto ga = std::gamma_distribution<double>(double(k_));
+            auto gb = std::gamma_distribution<double>(double(n_ - k_ + 1));
+            const auto x = ga(urng_);
+            w_ = x / (x + gb(urng_));
+            next_skip();
+        }
+        return true;
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    sample() const noexcept {
+        return sample_;
+    }
+    //-----------------------------------------------------
+    const result_type&
+    result() const noexcept {
+        return sample_;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /// @brief uniform in (0,1]
+    double
+    uniform() {
+        return 1.0 - std::generate_canonical<double,
+            std::numeric_limits<double>::digits>(urng_);
+    }
+    //-----------------------------------------------------
+    size_type
+    uniform_index(size_type n) {
+        return std::uniform_int_distribution<size_type>(0, n - 1)(urng_);
+    }
+
+    //-----------------------------------------------------
+    void
+    start_skipping() {
+        w_ = std::exp(std::log(uniform()) / double(k_));
+        next_skip();
+    }
+    //-----------------------------------------------------
+    void
+    next_skip() {
+        const auto s = std::floor(std::log(uniform()) / std::log1p(-w_));
+        skip_ = (s < 9e18) ? size_type(s) : std::numeric_limits<size_type>::max();
+    }
+    //-----------------------------------------------------
+    void
+    replace(const argument_type& x) {
+        sample_[std::size_t(uniform_index(k_))] = x;
+        w_ *= std::exp(std::log(uniform()) / double(k_));
+        next_skip();
+    }
+
+
+    //---------------------------------------------------------------
+    std::size_t k_;
+    size_type n_;
+    size_type skip_;
+    double w_;
+    result_type sample_;
+    random_engine urng_;
+};
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief weighted random sample of (at most) k values of a stream;
+ *        each value is included with probability proportional to its weight
+ *        (sampling without replacement; A-ExpJ, Efraimidis & Spirakis, 2006)
+ *
+ * @details every sampled value has the key u^(1/w) (kept as log(u)/w);
+ *          the reservoir holds the k largest keys in a min-heap;
+ *          exponential jumps: the total weight that can be skipped until
+ *          the next replacement is drawn once, so skipped values only
+ *          subtract their weight;
+ *          reproducible for a given seed
+ *
+ *****************************************************************************/
+template<
+    class Arg,
+    class Weight = double,
+    class URNG = std::mt19937_64
+>
+class weighted_reservoir_accumulator
+{
+    struct item {
+        double key;
+        Arg value;
+        friend bool operator < (const item& a, const item& b) noexcept {
+            return a.key < b.key;
+        }
+        friend bool operator > (const item& a, const item& b) noexcept {
+            return a.key > b.key;
+        }
+    };
+
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using weight_type   = Weight;
+    using result_type   = std::vector<Arg>;
+    using size_type     = std::uint_least64_t;
+    using random_engine = URNG;
+
+
+    //---------------------------------------------------------------
+    explicit
+    weighted_reservoir_accumulator(std::size_t k = 100,
+                                   typename URNG::result_type seed = URNG::default_seed)
+    :
+        k_(k > 0 ? k : 1), n_(0), jump_(0), heap_{}, urng_(seed)
+    {
+        heap_.reserve(k_);
+    }
+
+
+    //---------------------------------------------------------------
+    std::size_t
+    capacity() const noexcept {
+        return k_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of values seen
+    size_type
+    size() const noexcept {
+        return n_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (n_ < 1);
+    }
+    //-----------------------------------------------------
+    void
+    seed(typename URNG::result_type s) {
+        urng_.seed(s);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        n_ = 0;
+        jump_ = 0;
+        heap_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief pushes a value with weight 1
+    weighted_reservoir_accumulator&
+    operator += (const argument_type& x) {
+        push(x, weight_type(1));
+        return *this;
+    }
+    //-----------------------------------------------------
+    /// @brief values with non-positive weights are ignored
+    void
+    push(const argument_type& x, const weight_type& weight) {
+        const auto w = double(weight);
+        if(!(w > 0)) return;
+        ++n_;
+
+        if(heap_.size() < k_) {
+            heap_.push_back(item{std::log(uniform()) / w, x});
+            std::push_heap(heap_.begin(), heap_.end(), std::greater<item>{});
+            if(heap_.size() == k_) next_jump();
+            return;
+        }
+
+        jump_ -= w;
+        if(jump_ > 0) return;
+
+        //new key, conditioned on exceeding the current threshold
+        const auto t = std::exp(w * threshold());
+        const auto r = t + (1.0 - t) * (1.0 - uniform());
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<item>{});
+        heap_.back() = item{std::log(std::max(r, t)) / w, x};
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<item>{});
+        next_jump();
+    }
+    //-----------------------------------------------------
+    /// @brief values [first,last) with weights starting at 'weights'
+    template<class InputIterator, class WeightIterator>
+    void
+    push(InputIterator first, InputIterator last, WeightIterator weights) {
+        for(; first != last; ++first, ++weights) {
+            push(*first, *weights);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief combines with the sample of another (disjoint) stream
+    ///        by keeping the k largest keys of both reservoirs
+    /// @return false, if the capacities differ
+    bool
+    merge(const weighted_reservoir_accumulator& other) {
+        if(other.k_ != k_) return false;
+        if(&other == this) {
+            const auto h = heap_;
+            heap_.insert(heap_.end(), h.begin(), h.end());
+        } else {
+            heap_.insert(heap_.end(), other.heap_.begin(), other.heap_.end());
+        }
+        if(heap_.size() > k_) {
+            std::nth_element(heap_.begin(), heap_.begin() + k_, heap_.end(),
+                             std::greater<item>{});
+            heap_.resize(k_);
+        }
+        std::make_heap(heap_.begin(), heap_.end(), std::greater<item>{});
+        n_ += other.n_;
+        //the jump is only used once the reservoir is full;
+        //an underfull reservoir draws it when it fills up in push
+        if(heap_.size() == k_) next_jump();
+        return true;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief sampled values (in no particular order)
+    result_type
+    sample() const {
+        auto res = result_type{};
+        res.reserve(heap_.size());
+        for(const auto& i : heap_) res.push_back(i.value);
+        return res;
+    }
+    //-----------------------------------------------------
+    result_type
+    result() const {
+        return sample();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /// @brief uniform in (0,1]
+    double
+    uniform() {
+        return 1.0 - std::generate_canonical<double,
+            std::numeric_limits<double>::digits>(urng_);
+    }
+    //-----------------------------------------------------
+    /// @brief smallest key in the reservoir (log scale)
+    double
+    threshold() const noexcept {
+        return heap_.front().key;
+    }
+    //-----------------------------------------------------
+    /// @brief weight to skip: log(r) / log(threshold)
+    void
+    next_jump() {
+        jump_ = std::log(uniform()) / threshold();
+    }
+
+
+    //---------------------------------------------------------------
+    std::size_t k_;
+    size_type n_;
+    double jump_;
+    std::vector<item> heap_;
+    random_engine urng_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class URNG>
+inline decltype(auto)
+result(const reservoir_accumulator<Arg,URNG>& a) {
+    return a.result();
+}
+
+//---------------------------------------------------------
+template<class Arg, class Weight, class URNG>
+inline decltype(auto)
+result(const weighted_reservoir_accumulator<Arg,Weight,URNG>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
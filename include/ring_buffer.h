@@ -0,0 +1,308 @@
+#ifndef AMLIB_RING_BUFFER_H_
+#define AMLIB_RING_BUFFER_H_
+
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+
+
+namespace am {
+
+
+/*************************************************************************//***
+ *
+ * @brief growable FIFO container in one contiguous memory block
+ *    - capacity is always a power of two; positions are computed by masking
+ *    - values are inserted at the back and removed from the front
+ *    - the stored sequence is accessible as at most two contiguous ranges
+ *    - clear() and pop_front() keep the memory for reuse
+ *
+ *****************************************************************************/
+template<class T>
+class ring_buffer
+{
+    using mem_t = std::vector<T>;
+
+public:
+    //---------------------------------------------------------------
+    using value_type = T;
+    using size_type  = std::size_t;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+
+    //---------------------------------------------------------------
+    /// @brief contiguous part of the stored sequence
+    template<class Ptr>
+    class part
+    {
+    public:
+        constexpr part(Ptr first, size_type n) noexcept :
+            first_(first), n_(n)
+        {}
+
+        constexpr Ptr begin() const noexcept { return first_; }
+        constexpr Ptr end()   const noexcept { return first_ + n_; }
+        constexpr Ptr data()  const noexcept { return first_; }
+        constexpr size_type size() const noexcept { return n_; }
+        constexpr bool empty() const noexcept { return n_ < 1; }
+
+    private:
+        Ptr first_;
+        size_type n_;
+    };
+
+    using span       = part<value_type*>;
+    using const_span = part<const value_type*>;
+
+
+    //---------------------------------------------------------------
+    template<class Buffer, class Ref>
+    class iter
+    {
+        friend class ring_buffer;
+
+        constexpr iter(Buffer* buf, size_type pos) noexcept :
+            buf_(buf), pos_(pos)
+        {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type      = T;
+        using difference_type = std::ptrdiff_t;
+        using reference       = Ref;
+        using pointer         = std::remove_reference_t<Ref>*;
+
+        reference operator *  () const { return (*buf_)[pos_]; }
+        pointer   operator -> () const { return &(*buf_)[pos_]; }
+        reference operator [] (difference_type i) const {
+            return (*buf_)[pos_ + i];
+        }
+
+        iter& operator ++ () noexcept { ++pos_; return *this; }
+        iter& operator -- () noexcept { --pos_; return *this; }
+        iter  operator ++ (int) noexcept { auto o = *this; ++pos_; return o; }
+        iter  operator -- (int) noexcept { auto o = *this; --pos_; return o; }
+
+        iter& operator += (difference_type n) noexcept { pos_ += n; return *this; }
+        iter& operator -= (difference_type n) noexcept { pos_ -= n; return *this; }
+        iter  operator + (difference_type n) const noexcept { auto r = *this; return r += n; }
+        iter  operator - (difference_type n) const noexcept { auto r = *this; return r -= n; }
+
+        difference_type operator - (const iter& o) const noexcept {
+            return difference_type(pos_) - difference_type(o.pos_);
+        }
+
+        bool operator == (const iter& o) const noexcept { return pos_ == o.pos_; }
+        bool operator != (const iter& o) const noexcept { return pos_ != o.pos_; }
+        bool operator <  (const iter& o) const noexcept { return pos_ <  o.pos_; }
+        bool operator >  (const iter& o) const noexcept { return pos_ >  o.pos_; }
+        bool operator <= (const iter& o) const noexcept { return pos_ <= o.pos_; }
+        bool operator >= (const iter& o) const noexcept { return pos_ >= o.pos_; }
+
+    private:
+        Buffer* buf_;
+        size_type pos_;
+    };
+
+    using iterator       = iter<ring_buffer,reference>;
+    using const_iterator = iter<const ring_buffer,const_reference>;
+
+
+    //---------------------------------------------------------------
+    ring_buffer() :
+        mem_(), head_(0), size_(0), mask_(0)
+    {}
+    //-----------------------------------------------------
+    explicit
+    ring_buffer(size_type capacity) :
+        mem_(), head_(0), size_(0), mask_(0)
+    {
+        reserve(capacity);
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    size() const noexcept {
+        return size_;
+    }
+    //-----------------------------------------------------
+    size_type
+    capacity() const noexcept {
+        return mem_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (size_ < 1);
+    }
+    //-----------------------------------------------------
+    bool
+    full() const noexcept {
+        return (size_ >= mem_.size());
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief grows capacity to the smallest power of two >= n
+    void
+    reserve(size_type n) {
+        if(n <= mem_.size()) return;
+
+        auto cap = size_type(1);
+        while(cap < n) cap <<= 1;
+
+        mem_t mem;
+        mem.resize(cap);
+        for(size_type i = 0; i < size_; ++i) {
+            mem[i] = std::move((*this)[i]);
+        }
+        mem_.swap(mem);
+        head_ = 0;
+        mask_ = cap - 1;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief removes all values; keeps the memory
+    void
+    clear() noexcept {
+        head_ = 0;
+        size_ = 0;
+    }
+
+
+    //---------------------------------------------------------------
+    const_reference
+    operator [] (size_type i) const noexcept {
+        return mem_[(head_ + i) & mask_];
+    }
+    reference
+    operator [] (size_type i) noexcept {
+        return mem_[(head_ + i) & mask_];
+    }
+    //-----------------------------------------------------
+    const_reference
+    front() const noexcept {
+        return mem_[head_];
+    }
+    reference
+    front() noexcept {
+        return mem_[head_];
+    }
+    //-----------------------------------------------------
+    const_reference
+    back() const noexcept {
+        return mem_[(head_ + size_ - 1) & mask_];
+    }
+    reference
+    back() noexcept {
+        return mem_[(head_ + size_ - 1) & mask_];
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    push_back(const value_type& v) {
+        if(full()) reserve(mem_.size() + 1);
+        mem_[(head_ + size_) & mask_] = v;
+        ++size_;
+    }
+    //-----------------------------------------------------
+    void
+    push_back(value_type&& v) {
+        if(full()) reserve(mem_.size() + 1);
+        mem_[(head_ + size_) & mask_] = std::move(v);
+        ++size_;
+    }
+    //-----------------------------------------------------
+    template<class... Args>
+    void
+    emplace_back(Args&&... args) {
+        push_back(value_type{std::forward<Args>(args)...});
+    }
+    //-----------------------------------------------------
+    /// @brief appends [first,last) with at most two contiguous copy loops
+    template<class RandomAccessIterator>
+    void
+    push_back(RandomAccessIterator first, RandomAccessIterator last) {
+        using std::distance;
+        const auto n = size_type(distance(first, last));
+        reserve(size_ + n);
+
+        auto tail = (head_ + size_) & mask_;
+        const auto n1 = (mem_.size() - tail < n) ? (mem_.size() - tail) : n;
+        auto p = mem_.data() + tail;
+        for(size_type i = 0; i < n1; ++i, ++first) p[i] = *first;
+        p = mem_.data();
+        for(size_type i = n1; i < n; ++i, ++first) p[i-n1] = *first;
+
+        size_ += n;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    pop_front() noexcept {
+        if(size_ < 1) return;
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+    //-----------------------------------------------------
+    /// @brief removes the n oldest values in O(1)
+    void
+    pop_front(size_type n) noexcept {
+        if(n > size_) n = size_;
+        head_ = (head_ + n) & mask_;
+        size_ -= n;
+        if(size_ < 1) head_ = 0;
+    }
+    //-----------------------------------------------------
+    void
+    pop_back() noexcept {
+        if(size_ > 0) --size_;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief first (older) contiguous part of the stored sequence
+    const_span
+    first_span() const noexcept {
+        const auto n = (mem_.size() - head_ < size_) ? (mem_.size() - head_) : size_;
+        return const_span{mem_.data() + head_, n};
+    }
+    //-----------------------------------------------------
+    /// @brief second (newer) contiguous part of the stored sequence
+    const_span
+    second_span() const noexcept {
+        const auto n1 = first_span().size();
+        return const_span{mem_.data(), size_ - n1};
+    }
+
+
+    //---------------------------------------------------------------
+    iterator       begin()        noexcept { return iterator{this, 0}; }
+    const_iterator begin()  const noexcept { return const_iterator{this, 0}; }
+    const_iterator cbegin() const noexcept { return const_iterator{this, 0}; }
+
+    iterator       end()        noexcept { return iterator{this, size_}; }
+    const_iterator end()  const noexcept { return const_iterator{this, size_}; }
+    const_iterator cend() const noexcept { return const_iterator{this, size_}; }
+
+
+private:
+    mem_t mem_;
+    size_type head_;
+    size_type size_;
+    size_type mask_;
+};
+
+
+}  // namespace am
+
+
+#endif
@@ -0,0 +1,465 @@
+#ifndef AMLIB_STATISTICS_SPACE_SAVING_H_
+#define AMLIB_STATISTICS_SPACE_SAVING_H_
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief most frequent keys of an open-ended key stream
+ *        (Space-Saving; Metwally, Agrawal & El Abbadi, 2005)
+ *
+ * @details monitors at most 'capacity' keys; an unmonitored key replaces
+ *          the key with the smallest count and inherits that count as its
+ *          (over-)estimation error;
+ *          guarantees: estimate - error <= true count <= estimate and
+ *          error <= min_count() <= total() / capacity;
+ *          every key with a true count > total() / capacity is monitored
+ *
+ *          stream summary: counters with equal counts form a bucket;
+ *          buckets form a list ordered by count, so a unit update moves a
+ *          counter to the neighbouring bucket in O(1);
+ *          counters and buckets live in two index-linked arenas
+ *          (buckets are recycled through a free list)
+ *
+ *****************************************************************************/
+template<
+    class Key,
+    class Count = std::uint_least64_t,
+    class Hash = std::hash<Key>,
+    class KeyEqual = std::equal_to<Key>
+>
+class space_saving_accumulator
+{
+    static_assert(std::is_unsigned<Count>::value,
+        "space_saving_accumulator: count type must be unsigned");
+
+    static constexpr std::size_t npos = std::size_t(~std::size_t(0));
+
+    struct counter {
+        Key key;
+        Count count;
+        Count error;
+        std::size_t bucket;
+        std::size_t prev;
+        std::size_t next;
+    };
+
+    struct bucket {
+        Count count;
+        std::size_t first;
+        std::size_t prev;
+        std::size_t next;
+    };
+
+
+public:
+    //---------------------------------------------------------------
+    using key_type      = Key;
+    using count_type    = Count;
+    using argument_type = Key;
+    using size_type     = std::size_t;
+
+    struct entry {
+        key_type key;
+        count_type count;   ///< estimate (upper bound of the true count)
+        count_type error;   ///< maximum over-estimation
+    };
+
+    using result_type = std::vector<entry>;
+
+
+    //---------------------------------------------------------------
+    explicit
+    space_saving_accumulator(size_type capacity = 100,
+                             const Hash& hash = Hash{},
+                             const KeyEqual& keyEq = KeyEqual{})
+    :
+        capacity_(capacity > 0 ? capacity : 1), total_(0),
+        counters_{}, buckets_{}, freeBuckets_{},
+        minBucket_(npos), maxBucket_(npos),
+        index_(capacity_, hash, keyEq)
+    {
+        counters_.reserve(capacity_);
+        buckets_.reserve(capacity_);
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    capacity() const noexcept {
+        return capacity_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of monitored keys
+    size_type
+    size() const noexcept {
+        return counters_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return counters_.empty();
+    }
+    //-----------------------------------------------------
+    /// @brief total weight of all pushed keys
+    count_type
+    total() const noexcept {
+        return total_;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        total_ = 0;
+        counters_.clear();
+        buckets_.clear();
+        freeBuckets_.clear();
+        minBucket_ = npos;
+        maxBucket_ = npos;
+        index_.clear();
+    }
+    //-----------------------------------------------------
+    space_saving_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    space_saving_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x, count_type weight = 1) {
+        if(weight < 1) return;
+        total_ += weight;
+
+        const auto it = index_.find(x);
+        if(it != index_.end()) {
+            increment(it->second, weight);
+        }
+        else if(counters_.size() < capacity_) {
+            const auto c = counters_.size();
+            counters_.push_back(counter{x, weight, 0, npos, npos, npos});
+            index_.emplace(x, c);
+            attach_new(c);
+        }
+        else {
+            //replace key with minimum count; its count becomes the error
+            const auto c = buckets_[minBucket_].first;
+            auto& ctr = counters_[c];
+            index_.erase(ctr.key);
+            ctr.key = x;
+            ctr.error = ctr.count;
+            index_.emplace(x, c);
+            increment(c, weight);
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief runs of equal consecutive keys are counted first
+    ///        and pushed as one weighted update
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        if(first == last) return;
+        const auto& eq = index_.key_eq();
+        key_type run = *first;
+        count_type w = 1;
+        for(++first; first != last; ++first) {
+            if(eq(*first, run)) {
+                ++w;
+            } else {
+                push(run, w);
+                run = *first;
+                w = 1;
+            }
+        }
+        push(run, w);
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief combines two summaries (Agarwal et al., 2012);
+     *        keys unmonitored in one summary are assumed to have that
+     *        summary's min_count(), so the error bounds still hold
+     *        for the concatenated stream
+     */
+    void
+    merge(const space_saving_accumulator& other) {
+        const auto minA = min_count();
+        const auto minB = other.min_count();
+
+        auto all = std::vector<entry>{};
+        all.reserve(counters_.size() + other.counters_.size());
+
+        for(const auto& c : counters_) {
+            const auto it = other.index_.find(c.key);
+            if(it != other.index_.end()) {
+                const auto& o = other.counters_[it->second];
+                all.push_back(entry{c.key, c.count + o.count, c.error + o.error});
+            } else {
+                all.push_back(entry{c.key, c.count + minB, c.error + minB});
+            }
+        }
+        for(const auto& o : other.counters_) {
+            if(index_.find(o.key) == index_.end()) {
+                all.push_back(entry{o.key, o.count + minA, o.error + minA});
+            }
+        }
+
+        const auto tot = total_ + other.total_;
+        if(all.size() > capacity_) {
+            std::nth_element(all.begin(), all.begin() + capacity_, all.end(),
+                [](const entry& a, const entry& b) { return a.count > b.count; });
+            all.resize(capacity_);
+        }
+        std::sort(all.begin(), all.end(),
+            [](const entry& a, const entry& b) { return a.count < b.count; });
+
+        clear();
+        total_ = tot;
+        for(const auto& e : all) {
+            const auto c = counters_.size();
+            counters_.push_back(counter{e.key, e.count, e.error, npos, npos, npos});
+            index_.emplace(e.key, c);
+            //ascending counts => new counter belongs into the last bucket
+            if(maxBucket_ != npos && buckets_[maxBucket_].count == e.count) {
+                link_counter(c, maxBucket_);
+            } else {
+                link_counter(c, new_bucket(e.count, maxBucket_));
+            }
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief smallest monitored count if all counters are in use, 0 otherwise;
+    ///        upper bound for the count of every unmonitored key
+    count_type
+    min_count() const noexcept {
+        return (counters_.size() < capacity_ || minBucket_ == npos)
+            ? count_type(0) : buckets_[minBucket_].count;
+    }
+    //-----------------------------------------------------
+    bool
+    monitored(const key_type& key) const {
+        return index_.find(key) != index_.end();
+    }
+    //-----------------------------------------------------
+    /// @brief upper bound of the count of 'key'
+    count_type
+    estimate(const key_type& key) const {
+        const auto it = index_.find(key);
+        return (it != index_.end()) ? counters_[it->second].count : min_count();
+    }
+    //-----------------------------------------------------
+    /// @brief lower bound of the count of 'key'
+    count_type
+    guaranteed(const key_type& key) const {
+        const auto it = index_.find(key);
+        if(it == index_.end()) return 0;
+        const auto& c = counters_[it->second];
+        return c.count - c.error;
+    }
+    //-----------------------------------------------------
+    /// @brief maximum over-estimation of 'key'
+    count_type
+    error(const key_type& key) const {
+        const auto it = index_.find(key);
+        return (it != index_.end()) ? counters_[it->second].error : min_count();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief up to k monitored keys, highest estimates first
+    result_type
+    top(size_type k) const {
+        auto res = result_type{};
+        res.reserve(std::min(k, counters_.size()));
+        for(auto b = maxBucket_; b != npos && res.size() < k; b = buckets_[b].prev) {
+            for(auto c = buckets_[b].first; c != npos && res.size() < k;
+                c = counters_[c].next)
+            {
+                const auto& ctr = counters_[c];
+                res.push_back(entry{ctr.key, ctr.count, ctr.error});
+            }
+        }
+        return res;
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief all keys whose estimate exceeds phi * total(), highest first;
+     *        contains every key with a true frequency > phi
+     *        (if phi >= 1 / capacity())
+     * @param guaranteedOnly  only keys whose lower bound exceeds phi * total()
+     */
+    result_type
+    heavy_hitters(double phi, bool guaranteedOnly = false) const {
+        const auto threshold = phi * double(total_);
+        auto res = result_type{};
+        for(auto b = maxBucket_; b != npos; b = buckets_[b].prev) {
+            if(!(double(buckets_[b].count) > threshold)) break;
+            for(auto c = buckets_[b].first; c != npos; c = counters_[c].next) {
+                const auto& ctr = counters_[c];
+                if(!guaranteedOnly || double(ctr.count - ctr.error) > threshold) {
+                    res.push_back(entry{ctr.key, ctr.count, ctr.error});
+                }
+            }
+        }
+        return res;
+    }
+    //-----------------------------------------------------
+    /// @brief all monitored keys, highest estimates first
+    result_type
+    result() const {
+        return top(counters_.size());
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    /// @brief moves counter c to the bucket for count + w
+    void
+    increment(std::size_t c, count_type w) {
+        auto& ctr = counters_[c];
+        const auto from = ctr.bucket;
+        ctr.count += w;
+
+        //target: first bucket with count >= new count, searched from 'from'
+        auto pred = from;
+        auto b = buckets_[from].next;
+        while(b != npos && buckets_[b].count < ctr.count) {
+            pred = b;
+            b = buckets_[b].next;
+        }
+        unlink_counter(c);
+        if(b != npos && buckets_[b].count == ctr.count) {
+            link_counter(c, b);
+        } else {
+            link_counter(c, new_bucket(ctr.count, pred));
+        }
+        if(buckets_[from].first == npos) free_bucket(from);
+    }
+
+    //-----------------------------------------------------
+    /// @brief attaches a fresh counter; its bucket is searched from the minimum
+    void
+    attach_new(std::size_t c) {
+        const auto cnt = counters_[c].count;
+        auto pred = npos;
+        auto b = minBucket_;
+        while(b != npos && buckets_[b].count < cnt) {
+            pred = b;
+            b = buckets_[b].next;
+        }
+        if(b != npos && buckets_[b].count == cnt) {
+            link_counter(c, b);
+        } else {
+            link_counter(c, new_bucket(cnt, pred));
+        }
+    }
+
+    //-----------------------------------------------------
+    /// @brief creates a bucket right after 'pred' (or as new minimum if npos)
+    std::size_t
+    new_bucket(count_type count, std::size_t pred) {
+        std::size_t b;
+        if(!freeBuckets_.empty()) {
+            b = freeBuckets_.back();
+            freeBuckets_.pop_back();
+        } else {
+            b = buckets_.size();
+            buckets_.push_back(bucket{});
+        }
+        const auto succ = (pred != npos) ? buckets_[pred].next : minBucket_;
+        buckets_[b] = bucket{count, npos, pred, succ};
+        if(pred != npos) buckets_[pred].next = b; else minBucket_ = b;
+        if(succ != npos) buckets_[succ].prev = b; else maxBucket_ = b;
+        return b;
+    }
+    //-----------------------------------------------------
+    void
+    free_bucket(std::size_t b) {
+        const auto& bk = buckets_[b];
+        if(bk.prev != npos) buckets_[bk.prev].next = bk.next; else minBucket_ = bk.next;
+        if(bk.next != npos) buckets_[bk.next].prev = bk.prev; else maxBucket_ = bk.prev;
+        freeBuckets_.push_back(b);
+    }
+
+    //-----------------------------------------------------
+    void
+    link_counter(std::size_t c, std::size_t b) {
+        auto& ctr = counters_[c];
+        ctr.bucket = b;
+        ctr.prev = npos;
+        ctr.next = buckets_[b].first;
+        if(ctr.next != npos) counters_[ctr.next].prev = c;
+        buckets_[b].first = c;
+    }
+    //-----------------------------------------------------
+    void
+    unlink_counter(std::size_t c) {
+        const auto& ctr = counters_[c];
+        if(ctr.prev != npos) {
+            counters_[ctr.prev].next = ctr.next;
+        } else {
+            buckets_[ctr.bucket].first = ctr.next;
+        }
+        if(ctr.next != npos) counters_[ctr.next].prev = ctr.prev;
+    }
+
+
+    //---------------------------------------------------------------
+    size_type capacity_;
+    count_type total_;
+    std::vector<counter> counters_;
+    std::vector<bucket> buckets_;
+    std::vector<std::size_t> freeBuckets_;
+    std::size_t minBucket_;
+    std::size_t maxBucket_;
+    std::unordered_map<key_type,std::size_t,Hash,KeyEqual> index_;
+};
+
+
+template<class K, class C, class H, class E>
+constexpr std::size_t space_saving_accumulator<K,C,H,E>::npos;
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class K, class C, class H, class E>
+inline decltype(auto)
+result(const space_saving_accumulator<K,C,H,E>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef AMLIB_STATISTICS_TDIGEST_H_
+#define AMLIB_STATISTICS_TDIGEST_H_
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief streaming quantile estimation with a merging t-digest
+ *
+ * @details samples are collected in an insert buffer; a full buffer is
+ *          sorted and merged with the existing centroids in one pass
+ *          (amortized O(log b) per sample for buffer size b);
+ *          centroid sizes are bounded by the arcsine scale function,
+ *          so the tails (p99, p999) are resolved much finer than the median;
+ *          digests can be merged, e.g. to combine per-shard statistics
+ *
+ * @tparam Real  floating-point type of centroid means and weights
+ *
+ *****************************************************************************/
+template<class Arg, class Real = double>
+class tdigest_accumulator
+{
+    static_assert(std::is_floating_point<Real>::value,
+        "tdigest_accumulator<Arg,Real>: Real must be a floating-point type");
+
+    struct centroid {
+        Real mean;
+        Real weight;
+        friend bool operator < (const centroid& a, const centroid& b) noexcept {
+            return a.mean < b.mean;
+        }
+    };
+
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = Real;
+    using size_type     = std::uint_least64_t;
+
+
+    //---------------------------------------------------------------
+    /**
+     * @param compression  δ; the digest keeps at most about δ centroids;
+     *                     higher values => more accurate, more memory
+     */
+    explicit
+    tdigest_accumulator(Real compression = Real(100)):
+        compression_(compression > Real(10) ? compression : Real(10)),
+        bufSize_(size_type(5 * compression_)),
+        centroids_{}, buffer_{}, merged_{},
+        weight_(0), min_(0), max_(0)
+    {
+        centroids_.reserve(size_type(2 * compression_));
+        buffer_.reserve(bufSize_);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        centroids_.clear();
+        buffer_.clear();
+        weight_ = 0;
+        min_ = Real(0);
+        max_ = Real(0);
+    }
+    //-----------------------------------------------------
+    tdigest_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    tdigest_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        add(Real(x), Real(1));
+    }
+    //-----------------------------------------------------
+    /// @brief adds x with a (positive) weight
+    void
+    push(const argument_type& x, Real weight) {
+        if(weight > Real(0)) add(Real(x), weight);
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            add(Real(*first), Real(1));
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const tdigest_accumulator& other) {
+        if(!(other.weight_ > Real(0))) return;
+        if(!(weight_ > Real(0))) {
+            min_ = other.min_;
+            max_ = other.max_;
+        } else {
+            if(other.min_ < min_) min_ = other.min_;
+            if(other.max_ > max_) max_ = other.max_;
+        }
+        weight_ += other.weight_;
+        buffer_.insert(buffer_.end(),
+                       other.centroids_.begin(), other.centroids_.end());
+        buffer_.insert(buffer_.end(),
+                       other.buffer_.begin(), other.buffer_.end());
+        compress();
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief merges the insert buffer into the centroids;
+     *        const queries never modify the digest: with a non-empty insert
+     *        buffer they work on a temporary compressed copy, so calling
+     *        compress() first makes repeated queries cheaper
+     */
+    void
+    compress() {
+        if(buffer_.empty()) return;
+        buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+        merge_centroids(buffer_, merged_);
+        centroids_.swap(merged_);
+        buffer_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief number of samples (sum of weights for weighted samples)
+    size_type
+    size() const noexcept {
+        return size_type(weight_);
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return !(weight_ > Real(0));
+    }
+    //-----------------------------------------------------
+    /// @brief number of centroids (after compressing the insert buffer)
+    std::size_t
+    centroid_count() const {
+        return buffer_.empty() ? centroids_.size() : compressed().size();
+    }
+    //-----------------------------------------------------
+    const Real&
+    compression() const noexcept {
+        return compression_;
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    min() const noexcept {
+        return min_;
+    }
+    //-----------------------------------------------------
+    const result_type&
+    max() const noexcept {
+        return max_;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief estimates the q-quantile (0 <= q <= 1); 0 if empty
+    result_type
+    quantile(Real q) const {
+        return buffer_.empty() ? quantile(centroids_, q)
+                               : quantile(compressed(), q);
+    }
+    //-----------------------------------------------------
+    result_type
+    median() const {
+        return quantile(Real(0.5));
+    }
+    //-----------------------------------------------------
+    result_type
+    result() const {
+        return median();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    result_type
+    quantile(const std::vector<centroid>& centroids, Real q) const {
+        if(centroids.empty()) return Real(0);
+        if(!(q > Real(0))) return min_;
+        if(!(q < Real(1))) return max_;
+        if(centroids.size() == 1) return centroids.front().mean;
+
+        const auto total = weight_;
+        const auto idx = q * total;
+
+        //between min and center of first centroid
+        const auto& first = centroids.front();
+        if(idx < first.weight / 2) {
+            return min_ + (first.mean - min_) * (idx / (first.weight / 2));
+        }
+        //between center of last centroid and max
+        const auto& last = centroids.back();
+        if(idx > total - last.weight / 2) {
+            const auto d = (total - idx) / (last.weight / 2);
+            return max_ - (max_ - last.mean) * d;
+        }
+        //interpolate between centers of neighboring centroids
+        Real w = first.weight / 2;
+        for(std::size_t i = 1; i < centroids.size(); ++i) {
+            const auto& a = centroids[i-1];
+            const auto& b = centroids[i];
+            const auto dw = (a.weight + b.weight) / 2;
+            if(idx < w + dw) {
+                return a.mean + (b.mean - a.mean) * ((idx - w) / dw);
+            }
+            w += dw;
+        }
+        return last.mean;
+    }
+
+    //-----------------------------------------------------
+    /// @brief centroids and insert buffer merged into a new vector
+    std::vector<centroid>
+    compressed() const {
+        auto all = buffer_;
+        all.insert(all.end(), centroids_.begin(), centroids_.end());
+        auto res = std::vector<centroid>{};
+        merge_centroids(all, res);
+        return res;
+    }
+    //-----------------------------------------------------
+    /// @brief sorts 'in' and merges neighbors as far as the scale function
+    ///        allows; writes the resulting centroids to 'out'
+    void
+    merge_centroids(std::vector<centroid>& in, std::vector<centroid>& out) const {
+        std::sort(in.begin(), in.end());
+
+        Real total = 0;
+        for(const auto& c : in) total += c.weight;
+
+        out.clear();
+        auto cur = in.front();
+        Real wSoFar = 0;
+        Real wLimit = total * q_limit(Real(0));
+
+        for(auto i = in.begin() + 1; i != in.end(); ++i) {
+            if(wSoFar + cur.weight + i->weight <= wLimit) {
+                cur.weight += i->weight;
+                cur.mean += (i->mean - cur.mean) * i->weight / cur.weight;
+            }
+            else {
+                wSoFar += cur.weight;
+                out.push_back(cur);
+                wLimit = total * q_limit(wSoFar / total);
+                cur = *i;
+            }
+        }
+        out.push_back(cur);
+    }
+
+    //-----------------------------------------------------
+    void
+    add(Real x, Real weight) {
+        if(!(weight_ > Real(0))) {
+            min_ = x;
+            max_ = x;
+        } else {
+            if(x < min_) min_ = x;
+            if(x > max_) max_ = x;
+        }
+        weight_ += weight;
+        buffer_.push_back(centroid{x, weight});
+        if(buffer_.size() >= bufSize_) compress();
+    }
+
+    //-----------------------------------------------------
+    /// @brief largest quantile that a centroid starting at q0 may reach:
+    ///        q(k(q0) + 1) with k(q) = δ/(2π) * asin(2q-1)
+    Real
+    q_limit(Real q0) const noexcept {
+        using std::asin;
+        using std::sin;
+        const auto pi = Real(3.141592653589793238462643383279502884);
+        const auto hpi = pi / 2;
+        if(q0 > Real(1)) q0 = Real(1);
+        const auto k = asin(Real(2) * q0 - Real(1)) + Real(2) * pi / compression_;
+        return (k >= hpi) ? Real(1) : (sin(k) + Real(1)) / Real(2);
+    }
+
+
+    //---------------------------------------------------------------
+    Real compression_;
+    std::size_t bufSize_;
+    std::vector<centroid> centroids_;
+    std::vector<centroid> buffer_;
+    std::vector<centroid> merged_;
+    Real weight_;
+    result_type min_;
+    result_type max_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Real>
+inline decltype(auto)
+result(const tdigest_accumulator<Arg,Real>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
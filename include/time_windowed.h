@@ -0,0 +1,196 @@
+#ifndef AMLIB_STATISTICS_TIME_WINDOWED_H_
+#define AMLIB_STATISTICS_TIME_WINDOWED_H_
+
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+#include "ring_buffer.h"
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief accumulator decorator that restricts a reversible accumulator
+ *        to all samples whose timestamps are not older than a maximum age
+ *
+ * @details the window at time 'now' spans (now - max_age, now];
+ *          timestamps must be non-decreasing: samples with timestamps
+ *          earlier than now() are dropped, so the buffer stays sorted;
+ *          (timestamp,value) pairs are kept in a contiguous ring buffer;
+ *          all expired samples are found with one binary search and
+ *          then subtracted (-=) from the accumulator in one pass
+ *
+ * @tparam Time      timestamp type (number or std::chrono::time_point)
+ * @tparam Duration  type of 'max_age' (Time - Duration must yield a Time)
+ *
+ ****************************************************************************/
+template<class Accumulator, class Time = double, class Duration = Time>
+class time_windowed
+{
+    using entry_t = std::pair<Time,typename Accumulator::argument_type>;
+
+public:
+    //---------------------------------------------------------------
+    using argument_type = typename Accumulator::argument_type;
+    using result_type   = Accumulator;
+    using time_type     = Time;
+    using duration_type = Duration;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    time_windowed(const duration_type& maxAge):
+        acc_{}, buffer_{}, maxAge_(maxAge), now_{}, started_(false)
+    {}
+
+
+    //---------------------------------------------------------------
+    const duration_type&
+    max_age() const noexcept {
+        return maxAge_;
+    }
+    //-----------------------------------------------------
+    /// @brief evicts samples that are too old for the new maximum age
+    void
+    max_age(const duration_type& maxAge) {
+        maxAge_ = maxAge;
+        if(!buffer_.empty()) advance(now_);
+    }
+    //-----------------------------------------------------
+    /// @brief latest time seen by push or advance (since the last clear)
+    const time_type&
+    now() const noexcept {
+        return now_;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return buffer_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return buffer_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief also resets the current time
+    void
+    clear() {
+        acc_.clear();
+        buffer_.clear();
+        now_ = time_type{};
+        started_ = false;
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief inserts a sample and evicts all samples that expired by time t
+     * @return false, if the sample was dropped because t is earlier than now()
+     */
+    bool
+    push(const time_type& t, const argument_type& x) {
+        if(started_ && t < now_) return false;
+        advance(t);
+        acc_ += x;
+        buffer_.push_back(entry_t{t, x});
+        return true;
+    }
+    //-----------------------------------------------------
+    /// @brief samples with timestamps earlier than now() are dropped
+    template<class TimeIterator, class ValueIterator>
+    void
+    push(TimeIterator t, TimeIterator tEnd, ValueIterator x) {
+        for(; t != tEnd; ++t, ++x) {
+            push(*t, *x);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /**
+     * @brief advances the current time and evicts all expired samples
+     *        in one batch; times earlier than now() are ignored
+     * @return number of evicted samples
+     */
+    size_type
+    advance(const time_type& now) {
+        if(started_ && now < now_) return 0;
+        now_ = now;
+        started_ = true;
+        if(buffer_.empty()) return 0;
+
+        const auto oldest = now - maxAge_;
+        //oldest sample is still in the window => nothing to do
+        if(oldest < buffer_.front().first) return 0;
+
+        const auto last = std::upper_bound(buffer_.begin(), buffer_.end(), oldest,
+            [](const time_type& t, const entry_t& e) { return t < e.first; });
+
+        const auto n = size_type(last - buffer_.begin());
+        for(auto i = buffer_.begin(); i != last; ++i) {
+            acc_ -= i->second;
+        }
+        buffer_.pop_front(n);
+        return n;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief timestamp of the oldest sample in the window; undefined if empty
+    const time_type&
+    oldest() const noexcept {
+        return buffer_.front().first;
+    }
+    //-----------------------------------------------------
+    /// @brief value of the newest sample; undefined if empty
+    const argument_type&
+    top() const noexcept {
+        return buffer_.back().second;
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    result() const noexcept {
+        return acc_;
+    }
+
+
+private:
+    Accumulator acc_;
+    am::ring_buffer<entry_t> buffer_;
+    duration_type maxAge_;
+    time_type now_;
+    bool started_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Accumulator, class Time, class Duration>
+inline decltype(auto)
+result(const time_windowed<Accumulator,Time,Duration>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
@@ -117,6 +117,12 @@ public:
     pop(const argument_type& x) {
         tot_ -= x;
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const sum_accumulator& other) {
+        tot_ += other.tot_;
+    }
 
 
     //---------------------------------------------------------------
@@ -212,6 +218,13 @@ public:
     pop(const argument_type& x) {
         push(-x);
     }
+    //-----------------------------------------------------
+    /// @brief combines with the statistics of another sample
+    void
+    merge(const compensated_sum_accumulator& other) {
+        push(other.tot_);
+        push(-other.err_);
+    }
 
 
     //---------------------------------------------------------------
@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <type_traits>
 
+#include "normalized_view.h"
+
 
 namespace am {
 namespace stat {
@@ -86,6 +88,21 @@ public:
     }
 
 
+    //-----------------------------------------------------
+    /// @brief changes range and bin width, sets all counts to zero;
+    ///        reuses the bin storage if possible
+    void
+    reset(argument_type min, argument_type max, argument_type binWidth) {
+        using std::swap;
+        if(min > max) swap(min,max);
+        min_ = std::move(min);
+        width_ = (binWidth > 0) ? std::move(binWidth) : argument_type(0);
+        const auto s = required_size(min_,max,width_);
+        bins_.assign(s, value_type(0));
+        max_ = min_ + width_ * s;
+    }
+
+
     //---------------------------------------------------------------
     void
     expand(argument_type newMin, argument_type newMax) {
@@ -155,13 +172,42 @@ public:
         }
     }
     //-----------------------------------------------------
-    template<class InputIterator>
+    /// @brief increases the count of x's bin by 'weight'
+    void
+    insert(const argument_type& x, const count_type& weight) {
+        if(x >= min_ && (x < max_)) {
+            bins_[static_cast<size_type>((x - min_) / width_)] += weight;
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_arithmetic<InputIterator>::value>>
     void
     insert(InputIterator begin, InputIterator end) {
         for(; begin != end; ++begin) {
             insert(*begin);
         }
     }
+    //-----------------------------------------------------
+    /// @brief inserts values [begin,end) with weights starting at 'weights'
+    template<class InputIterator, class WeightIterator>
+    void
+    insert(InputIterator begin, InputIterator end, WeightIterator weights) {
+        for(; begin != end; ++begin, ++weights) {
+            insert(*begin, *weights);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief multiplies all counts by 'factor'
+    template<class Factor>
+    void
+    scale(const Factor& factor) {
+        for(auto& x : bins_) {
+            x *= factor;
+        }
+    }
 
 
     //---------------------------------------------------------------
@@ -179,11 +225,17 @@ public:
         return (x >= min_ && (x < max_));
     }
     //-----------------------------------------------------
-    iterator
+    const_iterator
     find(const argument_type& x) const noexcept {
+        return begin() + index(x);
+    }
+    //-----------------------------------------------------
+    /// @brief index of the bin that x falls in; size() if out of range
+    size_type
+    index(const argument_type& x) const noexcept {
         return range_includes(x)
-            ? begin() + static_cast<size_type>((x - min_) / width_)
-            : end();
+            ? static_cast<size_type>((x - min_) / width_)
+            : bins_.size();
     }
 
 
@@ -212,7 +264,7 @@ public:
     //-----------------------------------------------------
     value_type
     total() const {
-        return std::accumulate(begin(), end(), argument_type(0));
+        return std::accumulate(begin(), end(), value_type(0));
     }
 
 
@@ -368,23 +420,90 @@ print(Ostream& os, const uniform_histogram<Argument,Bins>& h)
 
 
 //-------------------------------------------------------------------
+/**
+ * @brief writes the relative frequency of each bin to 'out'
+ *        no memory is allocated
+ */
+template<class Argument, class Bins, class OutputIterator>
+OutputIterator
+relative_frequencies(const uniform_histogram<Argument,Bins>& h,
+                     OutputIterator out)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    const auto tot = static_cast<fp_t>(h.total());
+    const auto rn = (tot != fp_t(0)) ? (fp_t(1) / tot) : fp_t(0);
+
+    for(const auto& x : h) {
+        *out = static_cast<fp_t>(x) * rn;
+        ++out;
+    }
+    return out;
+}
+
+//---------------------------------------------------------
 template<class Argument, class Bins>
 auto
 relative_frequencies(const uniform_histogram<Argument,Bins>& h)
 {
     using fp_t = std::common_type_t<Argument,double>;
 
-    auto res = std::vector<fp_t>{};
-    res.assign(h.begin(), h.end());
-
-    const auto rn = fp_t(1) / static_cast<fp_t>(h.total());
-    for(auto& x :res) {
-        x *= rn;
-    }
+    auto res = std::vector<fp_t>(h.size());
+    relative_frequencies(h, res.begin());
 
     return res;
 }
 
+//---------------------------------------------------------
+/**
+ * @brief lazy view of the relative bin frequencies of 'h'
+ *        'h' must outlive the view; changes of bin counts are reflected
+ *        as long as the total is not changed
+ */
+template<class Argument, class Bins>
+auto
+normalized(const uniform_histogram<Argument,Bins>& h)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+    using view_t = normalized_view<
+        typename uniform_histogram<Argument,Bins>::const_iterator,
+        detail::identity_projection, fp_t>;
+
+    return view_t{h.begin(), h.end(), static_cast<fp_t>(h.total())};
+}
+
+
+
+//-------------------------------------------------------------------
+/**
+ * @brief estimates the q-quantile (0 <= q <= 1) of the values inserted into
+ *        'h' assuming that values are uniformly distributed within each bin
+ */
+template<class Argument, class Bins>
+auto
+quantile(const uniform_histogram<Argument,Bins>& h, double q)
+{
+    using fp_t = std::common_type_t<Argument,double>;
+
+    const auto tot = static_cast<fp_t>(h.total());
+    if(!(tot > fp_t(0))) return static_cast<fp_t>(h.min());
+
+    if(q < 0) q = 0;
+    if(q > 1) q = 1;
+    const auto target = fp_t(q) * tot;
+
+    auto cum = fp_t(0);
+    for(std::size_t i = 0; i < h.size(); ++i) {
+        const auto c = static_cast<fp_t>(h[i]);
+        if(c > fp_t(0) && cum + c >= target) {
+            return static_cast<fp_t>(h.min()) +
+                   (fp_t(i) + (target - cum) / c) * fp_t(h.bin_width());
+        }
+        cum += c;
+    }
+    return static_cast<fp_t>(h.max());
+}
+
 
 
 } //namespace stat
@@ -0,0 +1,451 @@
+#ifndef AMLIB_STATISTICS_UNIFORM_HISTOGRAM_ND_H_
+#define AMLIB_STATISTICS_UNIFORM_HISTOGRAM_ND_H_
+
+#include <vector>
+#include <array>
+#include <numeric>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief holds a flat, contiguous vector of bin counts over a
+ *        'dims'-dimensional grid; bins have the same width along each axis
+ *        bins are stored in row-major order (last axis varies fastest)
+ *        insert(p) increases the count of the bin that point p falls in
+ *        operator()(p) returns the count of the bin that point p falls in
+ *
+ *****************************************************************************/
+template<
+    class Argument,
+    std::size_t dims,
+    class Count = std::uint_least32_t
+>
+class uniform_histogram_nd
+{
+    static_assert(dims > 0, "uniform_histogram_nd: dims must be at least 1");
+
+    using bins_type = std::vector<Count>;
+
+public:
+    //---------------------------------------------------------------
+    using value_type = Count;
+    using count_type = value_type;
+    using size_type  = typename bins_type::size_type;
+    //-----------------------------------------------------
+    using const_iterator = typename bins_type::const_iterator;
+    using iterator       = typename bins_type::iterator;
+    //-----------------------------------------------------
+    using argument_type = Argument;
+    using numeric_type  = argument_type;
+    using point_type    = std::array<argument_type,dims>;
+    using shape_type    = std::array<size_type,dims>;
+
+
+    //---------------------------------------------------------------
+    static constexpr std::size_t
+    dimensions() noexcept {
+        return dims;
+    }
+
+
+    //---------------------------------------------------------------
+    explicit
+    uniform_histogram_nd() :
+        min_{}, max_{}, width_{}, shape_{}, strides_{}, bins_()
+    {}
+    //-----------------------------------------------------
+    explicit
+    uniform_histogram_nd(
+        const point_type& min, const point_type& max, const point_type& binWidth)
+    :
+        min_{}, max_{}, width_{}, shape_{}, strides_{}, bins_()
+    {
+        reset(min, max, binWidth);
+    }
+
+    //-----------------------------------------------------
+    uniform_histogram_nd(const uniform_histogram_nd&) = default;
+    uniform_histogram_nd(uniform_histogram_nd&&)      = default;
+
+
+    //---------------------------------------------------------------
+    uniform_histogram_nd& operator = (const uniform_histogram_nd&) = default;
+    uniform_histogram_nd& operator = (uniform_histogram_nd&&)      = default;
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        for(auto& x : bins_) {
+            x = count_type(0);
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief changes the grid; reuses the bin storage if possible
+    void
+    reset(const point_type& min, const point_type& max,
+          const point_type& binWidth)
+    {
+        using std::swap;
+
+        for(std::size_t d = 0; d < dims; ++d) {
+            min_[d] = min[d];
+            max_[d] = max[d];
+            if(min_[d] > max_[d]) swap(min_[d], max_[d]);
+            width_[d] = (binWidth[d] > 0) ? binWidth[d] : argument_type(0);
+            shape_[d] = required_size(min_[d], max_[d], width_[d]);
+            max_[d] = min_[d] + width_[d] * shape_[d];
+        }
+
+        auto stride = size_type(1);
+        for(std::size_t d = dims; d > 0; --d) {
+            strides_[d-1] = stride;
+            stride *= shape_[d-1];
+        }
+
+        bins_.assign(stride, count_type(0));
+    }
+
+
+    //---------------------------------------------------------------
+    const point_type&
+    min() const noexcept {
+        return min_;
+    }
+    //-----------------------------------------------------
+    const point_type&
+    max() const noexcept {
+        return max_;
+    }
+    //-----------------------------------------------------
+    const point_type&
+    bin_width() const noexcept {
+        return width_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of bins along each axis
+    const shape_type&
+    shape() const noexcept {
+        return shape_;
+    }
+    //-----------------------------------------------------
+    /// @brief flat index distance between neighboring bins along each axis
+    const shape_type&
+    strides() const noexcept {
+        return strides_;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    insert(const point_type& p) {
+        const auto i = index(p);
+        if(i < bins_.size()) ++bins_[i];
+    }
+    //-----------------------------------------------------
+    /// @brief increases the count of p's bin by 'weight'
+    void
+    insert(const point_type& p, const count_type& weight) {
+        const auto i = index(p);
+        if(i < bins_.size()) bins_[i] += weight;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    insert(InputIterator begin, InputIterator end) {
+        for(; begin != end; ++begin) {
+            insert(*begin);
+        }
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief inserts n points given as one column (iterator) per axis
+     *        (structure of arrays);
+     *        flat indices are computed block-wise, one axis at a time,
+     *        so that the inner loops are branch-free and vectorizable
+     */
+    template<class RandomAccessIterator>
+    void
+    insert(const std::array<RandomAccessIterator,dims>& columns, size_type n)
+    {
+        constexpr size_type blockSize = 256;
+
+        std::array<size_type,blockSize> idx;
+        std::array<unsigned char,blockSize> valid;
+
+        for(size_type first = 0; first < n; first += blockSize) {
+            const auto m = (n - first < blockSize) ? (n - first) : blockSize;
+
+            for(size_type j = 0; j < m; ++j) {
+                idx[j] = 0;
+                valid[j] = 1;
+            }
+            for(std::size_t d = 0; d < dims; ++d) {
+                const auto col    = columns[d] + first;
+                const auto lo     = min_[d];
+                const auto hi     = max_[d];
+                const auto w      = width_[d];
+                const auto stride = strides_[d];
+
+                for(size_type j = 0; j < m; ++j) {
+                    const argument_type x = col[j];
+                    const bool in = (x >= lo) & (x < hi);
+                    valid[j] &= static_cast<unsigned char>(in);
+                    idx[j] += in ? static_cast<size_type>((x - lo) / w) * stride
+                                 : size_type(0);
+                }
+            }
+            for(size_type j = 0; j < m; ++j) {
+                if(valid[j]) ++bins_[idx[j]];
+            }
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief lookup
+    value_type
+    operator () (const point_type& p) const noexcept {
+        const auto i = index(p);
+        return (i < bins_.size()) ? bins_[i] : value_type(0);
+    }
+    //-----------------------------------------------------
+    bool
+    range_includes(const point_type& p) const noexcept {
+        for(std::size_t d = 0; d < dims; ++d) {
+            if(!(p[d] >= min_[d] && p[d] < max_[d])) return false;
+        }
+        return true;
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief  fused row-major flat bin index of point p
+     * @return size() if p is not inside the histogram range
+     */
+    size_type
+    index(const point_type& p) const noexcept {
+        auto i = size_type(0);
+        for(std::size_t d = 0; d < dims; ++d) {
+            if(!(p[d] >= min_[d] && p[d] < max_[d])) return bins_.size();
+            i += static_cast<size_type>((p[d] - min_[d]) / width_[d]) * strides_[d];
+        }
+        return i;
+    }
+    //-----------------------------------------------------
+    /// @brief flat bin index of per-axis bin coordinates
+    size_type
+    flat_index(const shape_type& coords) const noexcept {
+        auto i = size_type(0);
+        for(std::size_t d = 0; d < dims; ++d) {
+            i += coords[d] * strides_[d];
+        }
+        return i;
+    }
+
+
+    //---------------------------------------------------------------
+    const value_type&
+    operator [] (size_type idx) const noexcept {
+        return bins_[idx];
+    }
+    value_type&
+    operator [] (size_type idx) noexcept {
+        return bins_[idx];
+    }
+    //-----------------------------------------------------
+    const value_type&
+    operator [] (const shape_type& coords) const noexcept {
+        return bins_[flat_index(coords)];
+    }
+    value_type&
+    operator [] (const shape_type& coords) noexcept {
+        return bins_[flat_index(coords)];
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    size() const noexcept {
+        return bins_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return bins_.empty();
+    }
+
+    //-----------------------------------------------------
+    value_type
+    total() const {
+        return std::accumulate(begin(), end(), value_type(0));
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief total count of all bins with coordinate i along axis 'axis'
+    value_type
+    marginal_count(std::size_t axis, size_type i) const noexcept {
+        if(bins_.empty()) return value_type(0);
+
+        //view bins as [outer][shape_[axis]][inner]
+        const auto inner = strides_[axis];
+        const auto outer = bins_.size() / (inner * shape_[axis]);
+        const auto step  = inner * shape_[axis];
+
+        auto sum = value_type(0);
+        auto p = bins_.data() + i * inner;
+        for(size_type o = 0; o < outer; ++o, p += step) {
+            for(size_type j = 0; j < inner; ++j) {
+                sum += p[j];
+            }
+        }
+        return sum;
+    }
+    //-----------------------------------------------------
+    /**
+     * @brief writes the marginal distribution along 'axis'
+     *        (shape()[axis] values) to 'out' using one linear pass over
+     *        all bins; 'out' must be a random access iterator
+     */
+    template<class RandomAccessIterator>
+    RandomAccessIterator
+    marginal(std::size_t axis, RandomAccessIterator out) const {
+        const auto n     = shape_[axis];
+        const auto inner = strides_[axis];
+
+        for(size_type i = 0; i < n; ++i) {
+            out[i] = 0;
+        }
+        if(bins_.empty()) return out + n;
+
+        auto p = bins_.data();
+        const auto end = p + bins_.size();
+        while(p != end) {
+            for(size_type i = 0; i < n; ++i) {
+                auto sum = value_type(0);
+                for(size_type j = 0; j < inner; ++j, ++p) {
+                    sum += *p;
+                }
+                out[i] += sum;
+            }
+        }
+        return out + n;
+    }
+
+
+    //---------------------------------------------------------------
+    iterator
+    begin() noexcept {
+        return bins_.begin();
+    }
+    //-----------------------------------------------------
+    const_iterator
+    begin() const noexcept {
+        return bins_.begin();
+    }
+    //-----------------------------------------------------
+    const_iterator
+    cbegin() const noexcept {
+        return bins_.begin();
+    }
+
+    //-----------------------------------------------------
+    iterator
+    end() noexcept {
+        return bins_.end();
+    }
+    //-----------------------------------------------------
+    const_iterator
+    end() const noexcept {
+        return bins_.end();
+    }
+    //-----------------------------------------------------
+    const_iterator
+    cend() const noexcept {
+        return bins_.end();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    static constexpr size_type
+    required_size(const argument_type& min, const argument_type& max,
+                  const argument_type& width) noexcept
+    {
+        return (width > 0)
+            ? static_cast<size_type>(0.5 + (max - min) / width)
+            : 0;
+    }
+
+
+    //---------------------------------------------------------------
+    point_type min_;
+    point_type max_;
+    point_type width_;
+    shape_type shape_;
+    shape_type strides_;
+    bins_type bins_;
+};
+
+
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *
+ *****************************************************************************/
+template<class Argument, std::size_t dims, class Count>
+inline decltype(auto)
+begin(const uniform_histogram_nd<Argument,dims,Count>& h)
+{
+    return h.begin();
+}
+//---------------------------------------------------------
+template<class Argument, std::size_t dims, class Count>
+inline decltype(auto)
+cbegin(const uniform_histogram_nd<Argument,dims,Count>& h)
+{
+    return h.begin();
+}
+
+//---------------------------------------------------------
+template<class Argument, std::size_t dims, class Count>
+inline decltype(auto)
+end(const uniform_histogram_nd<Argument,dims,Count>& h)
+{
+    return h.end();
+}
+//---------------------------------------------------------
+template<class Argument, std::size_t dims, class Count>
+inline decltype(auto)
+cend(const uniform_histogram_nd<Argument,dims,Count>& h)
+{
+    return h.end();
+}
+
+
+
+//---------------------------------------------------------------
+template<class Argument, class Count = std::uint_least32_t>
+using uniform_histogram_2d = uniform_histogram_nd<Argument,2,Count>;
+
+template<class Argument, class Count = std::uint_least32_t>
+using uniform_histogram_3d = uniform_histogram_nd<Argument,3,Count>;
+
+
+
+} //namespace stat
+}  // namespace am
+
+#endif
@@ -3,6 +3,11 @@
 
 
 #include <array>
+#include <cstddef>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
 
 
 namespace am {
@@ -12,30 +17,108 @@ namespace am {
  *
  * @brief container that keeps a fixed number of values in a rolling fashion
  *    - values can only be inserted at one side
- *    - only the first value and the last value in the window can be accessed
+ *    - once the buffer is full, inserting overwrites the oldest value in O(1)
+ *    - the window (oldest to newest) can be iterated or accessed as
+ *      at most two contiguous ranges
+ *    - memory is allocated in place
  *
  *****************************************************************************/
 template<class T, std::size_t windowSize>
 class window_buffer
 {
-    using mem_t   = std::array<T,windowSize>;
-    using iter_t = typename mem_t::iter_t;
-    using citer_t = typename mem_t::citer_t;
+    static_assert(windowSize > 0, "window_buffer: window size must be > 0");
+
+    using mem_t = std::array<T,windowSize>;
 
 public:
     //---------------------------------------------------------------
     using value_type = T;
     using size_type  = std::size_t;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+
+    //---------------------------------------------------------------
+    /// @brief contiguous part of the window
+    class const_span
+    {
+    public:
+        constexpr const_span(const value_type* first, size_type n) noexcept :
+            first_(first), n_(n)
+        {}
+
+        constexpr const value_type* begin() const noexcept { return first_; }
+        constexpr const value_type* end()   const noexcept { return first_ + n_; }
+        constexpr const value_type* data()  const noexcept { return first_; }
+        constexpr size_type size() const noexcept { return n_; }
+        constexpr bool empty() const noexcept { return n_ < 1; }
+
+    private:
+        const value_type* first_;
+        size_type n_;
+    };
+
+
+    //---------------------------------------------------------------
+    /// @brief iterates over the window from oldest to newest value
+    class const_iterator
+    {
+        friend class window_buffer;
+
+        constexpr const_iterator(const window_buffer* buf, size_type pos) noexcept :
+            buf_(buf), pos_(pos)
+        {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type      = T;
+        using difference_type = std::ptrdiff_t;
+        using reference       = const T&;
+        using pointer         = const T*;
+
+        reference operator *  () const { return (*buf_)[pos_]; }
+        pointer   operator -> () const { return &(*buf_)[pos_]; }
+        reference operator [] (difference_type i) const {
+            return (*buf_)[pos_ + i];
+        }
+
+        const_iterator& operator ++ () noexcept { ++pos_; return *this; }
+        const_iterator& operator -- () noexcept { --pos_; return *this; }
+        const_iterator  operator ++ (int) noexcept { auto o = *this; ++pos_; return o; }
+        const_iterator  operator -- (int) noexcept { auto o = *this; --pos_; return o; }
+
+        const_iterator& operator += (difference_type n) noexcept { pos_ += n; return *this; }
+        const_iterator& operator -= (difference_type n) noexcept { pos_ -= n; return *this; }
+        const_iterator  operator + (difference_type n) const noexcept { auto r = *this; return r += n; }
+        const_iterator  operator - (difference_type n) const noexcept { auto r = *this; return r -= n; }
+
+        difference_type operator - (const const_iterator& o) const noexcept {
+            return difference_type(pos_) - difference_type(o.pos_);
+        }
+
+        bool operator == (const const_iterator& o) const noexcept { return pos_ == o.pos_; }
+        bool operator != (const const_iterator& o) const noexcept { return pos_ != o.pos_; }
+        bool operator <  (const const_iterator& o) const noexcept { return pos_ <  o.pos_; }
+        bool operator >  (const const_iterator& o) const noexcept { return pos_ >  o.pos_; }
+        bool operator <= (const const_iterator& o) const noexcept { return pos_ <= o.pos_; }
+        bool operator >= (const const_iterator& o) const noexcept { return pos_ >= o.pos_; }
+
+    private:
+        const window_buffer* buf_;
+        size_type pos_;
+    };
+
+    using iterator = const_iterator;
 
 
     //---------------------------------------------------------------
     window_buffer() :
-        mem_(), beg_(mem_.begin()), end_(mem_.begin())
+        mem_(), beg_(0), size_(0)
     {}
 
     //-----------------------------------------------------
     window_buffer(std::initializer_list<value_type> il) :
-        mem_(), beg_(mem_.begin()), end_(mem_.begin())
+        mem_(), beg_(0), size_(0)
     {
         for(const auto& x : il) {
             push_back(x);
@@ -46,43 +129,48 @@ public:
     //---------------------------------------------------------------
     size_type
     size() const noexcept {
-        return distance(mem_.begin(), end_);
+        return size_;
     }
     //-----------------------------------------------------
-    static size_type
+    static constexpr size_type
     max_size() noexcept {
         return windowSize;
     }
     //-----------------------------------------------------
     bool
     empty() const noexcept {
-        return (mem_.begin() == end_);
+        return (size_ < 1);
     }
     //-----------------------------------------------------
     bool
     full() const noexcept {
-        return (mem_.end() == end_);
+        return (size_ >= windowSize);
     }
 
 
     //---------------------------------------------------------------
+    /// @brief i-th oldest value in the window
+    const value_type&
+    operator [] (size_type i) const noexcept {
+        return mem_[wrap(beg_ + i)];
+    }
+    //-----------------------------------------------------
     const value_type&
     front() const noexcept {
-        return *beg_;
+        return mem_[beg_];
     }
     //-----------------------------------------------------
     const value_type&
     back() const noexcept {
-        using std::prev;
-        return *prev(end_);
+        return mem_[wrap(beg_ + size_ - 1)];
     }
 
 
     //---------------------------------------------------------------
     void
     clear() {
-        beg_ = mem_.begin();
-        end_ = mem_.end();
+        beg_ = 0;
+        size_ = 0;
     }
 
 
@@ -90,33 +178,23 @@ public:
     void
     push_back(const value_type& v)
     {
-        using std::swap;
-
-        if(!full()) {
-            *end_ = v;
-            ++end_;
-        } else {
-            *beg_ = std::move(mem_.back());
-            ++beg_;
-            if(beg_ == prev(mem_.end())) beg_ = mem_.begin();
-            mem_.back() = v;
-        }
+        mem_[next_slot()] = v;
     }
-
     //-----------------------------------------------------
     void
     push_back(value_type&& v)
     {
-        using std::swap;
-
-        if(!full()) {
-            *end_ = std::move(v);
-            ++end_;
-        } else {
-            *beg_ = std::move(mem_.back());
-            ++beg_;
-            if(beg_ == prev(mem_.end())) beg_ = mem_.begin();
-            mem_.back() = std::move(v);
+        mem_[next_slot()] = std::move(v);
+    }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); only the last max_size() values are kept
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,value_type>::value>>
+    void
+    push_back(InputIterator first, InputIterator last)
+    {
+        for(; first != last; ++first) {
+            mem_[next_slot()] = *first;
         }
     }
 
@@ -128,10 +206,61 @@ public:
     }
 
 
+    //---------------------------------------------------------------
+    /// @brief removes the oldest value
+    void
+    pop_front() noexcept {
+        if(size_ < 1) return;
+        beg_ = wrap(beg_ + 1);
+        --size_;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief first (older) contiguous part of the window
+    const_span
+    first_span() const noexcept {
+        const auto n = (windowSize - beg_ < size_) ? (windowSize - beg_) : size_;
+        return const_span{mem_.data() + beg_, n};
+    }
+    //-----------------------------------------------------
+    /// @brief second (newer) contiguous part of the window
+    const_span
+    second_span() const noexcept {
+        return const_span{mem_.data(), size_ - first_span().size()};
+    }
+
+
+    //---------------------------------------------------------------
+    const_iterator begin()  const noexcept { return const_iterator{this, 0}; }
+    const_iterator cbegin() const noexcept { return const_iterator{this, 0}; }
+    const_iterator end()    const noexcept { return const_iterator{this, size_}; }
+    const_iterator cend()   const noexcept { return const_iterator{this, size_}; }
+
+
 private:
+    //---------------------------------------------------------------
+    static constexpr size_type
+    wrap(size_type i) noexcept {
+        return (i >= windowSize) ? (i - windowSize) : i;
+    }
+    //-----------------------------------------------------
+    /// @brief slot for a new value; drops the oldest value if full
+    size_type
+    next_slot() noexcept {
+        if(size_ < windowSize) {
+            return wrap(beg_ + size_++);
+        }
+        const auto i = beg_;
+        beg_ = wrap(beg_ + 1);
+        return i;
+    }
+
+
+    //---------------------------------------------------------------
     mem_t mem_;
-    iter_t beg_;
-    iter_t end_;
+    size_type beg_;
+    size_type size_;
 };
 
 
@@ -1,19 +1,50 @@
 #ifndef AMLIB_STATISTICS_WINDOWED_ACCUMULATOR_H_
 #define AMLIB_STATISTICS_WINDOWED_ACCUMULATOR_H_
 
-#include <queue>
+#include <cstddef>
+#include <type_traits>
 
+#include "ring_buffer.h"
 #include "window_buffer.h"
 
 
 namespace am {
 namespace stat {
 
+namespace detail {
+
+//-------------------------------------------------------------------
+/// @brief uses the accumulator's bulk push if it has one
+template<class Accumulator, class InputIterator>
+inline auto
+push_range(Accumulator& acc, InputIterator first, InputIterator last, int)
+    -> decltype(acc.push(first, last), void())
+{
+    acc.push(first, last);
+}
+
+template<class Accumulator, class InputIterator>
+inline void
+push_range(Accumulator& acc, InputIterator first, InputIterator last, long)
+{
+    for(; first != last; ++first) {
+        acc += *first;
+    }
+}
+
+} // namespace detail
+
 /*************************************************************************//***
  *
  * @brief accumulator decorator that restricts an accumulator to a fixed
  *        maximum number of values
  *
+ * @details values are added (+=) and removed (-=) from the accumulator;
+ *          for floating-point sums this accumulates rounding errors,
+ *          so the accumulator is rebuilt from the stored window after every
+ *          window_size() evictions if the argument type is a floating-point
+ *          type (see recompute_every; off by default for other types)
+ *
  ****************************************************************************/
 template<class Accumulator>
 class windowed
@@ -24,17 +55,23 @@ public:
     using result_type   = Accumulator;
     using size_type     = std::size_t;
 
+    /// @brief recompute interval that always equals the window size
+    static constexpr size_type per_window = size_type(~size_type(0));
+
 
     //---------------------------------------------------------------
-    constexpr
     windowed():
-        acc_{}, queue_{}, windowSize_(10)
+        acc_{}, buffer_(10), windowSize_(10),
+        rebuildInterval_(default_interval()), evictions_(0)
     {}
     //-----------------------------------------------------
-    explicit constexpr
+    explicit
     windowed(const argument_type& init):
-        acc_{init}, queue_{init}, windowSize_(10)
-    {}
+        acc_{}, buffer_(10), windowSize_(10),
+        rebuildInterval_(default_interval()), evictions_(0)
+    {
+        push(init);
+    }
 
     //-----------------------------------------------------
     windowed(const windowed&) = default;
@@ -54,26 +91,70 @@ public:
     //-----------------------------------------------------
     void
     resize_window(size_type size) {
-        for(size_type i = windowSize_; i > size && !queue_.empty(); --i) {
-            acc_ -= queue_.front();
-            queue_.pop();
+        if(buffer_.size() > size) {
+            evict(buffer_.size() - size);
         }
+        buffer_.reserve(size);
         windowSize_ = size;
     }
 
 
+    //---------------------------------------------------------------
+    /**
+     * @brief rebuild the accumulator from the stored window after every
+     *        k evictions (0 = never, per_window = window_size());
+     *        with k = window_size() this costs at most one extra
+     *        accumulator push per sample (amortized);
+     *        default: per_window for floating-point argument types, 0 otherwise
+     */
+    void
+    recompute_every(size_type k) noexcept {
+        rebuildInterval_ = k;
+    }
+    //-----------------------------------------------------
+    /// @brief current number of evictions between rebuilds (0 = never)
+    size_type
+    recompute_interval() const noexcept {
+        return (rebuildInterval_ == per_window) ? windowSize_ : rebuildInterval_;
+    }
+    //-----------------------------------------------------
+    /// @brief rebuilds the accumulator from the stored window
+    void
+    recompute() {
+        acc_.clear();
+        const auto s1 = buffer_.first_span();
+        const auto s2 = buffer_.second_span();
+        detail::push_range(acc_, s1.begin(), s1.end(), 0);
+        detail::push_range(acc_, s2.begin(), s2.end(), 0);
+        evictions_ = 0;
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return buffer_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return buffer_.empty();
+    }
+
+
     //---------------------------------------------------------------
     void
     clear() {
         acc_.clear();
-        queue_.clear();
+        buffer_.clear();
+        evictions_ = 0;
     }
     //-----------------------------------------------------
     windowed&
     operator = (const argument_type& x) {
-        acc_ = x;
-        queue_.clear();
-        queue_.push(x);
+        clear();
+        push(x);
         return *this;
     }
 
@@ -81,7 +162,7 @@ public:
     //---------------------------------------------------------------
     const argument_type&
     top() const {
-        return queue_.back();
+        return buffer_.back();
     }
 
 
@@ -94,22 +175,48 @@ public:
     //-----------------------------------------------------
     void
     push(const argument_type& x) {
-        if(queue_.size() >= window_size()) {
-            acc_ -= queue_.front();
-            queue_.pop();
+        if(!buffer_.empty() && buffer_.size() >= window_size()) {
+            acc_ -= buffer_.front();
+            buffer_.pop_front();
+            ++evictions_;
         }
         acc_ += x;
-        queue_.push(x);
+        buffer_.push_back(x);
+        const auto k = recompute_interval();
+        if(k > 0 && evictions_ >= k) {
+            recompute();
+        }
+    }
+    //-----------------------------------------------------
+    /// @brief pushes [first,last); only the last window_size() values
+    ///        are stored
+    template<class RandomAccessIterator>
+    void
+    push(RandomAccessIterator first, RandomAccessIterator last) {
+        using std::distance;
+
+        const auto n = size_type(distance(first, last));
+        if(n > windowSize_) {
+            first += (n - windowSize_);
+            clear();
+        }
+        else {
+            const auto total = buffer_.size() + n;
+            if(total > windowSize_) evict(total - windowSize_);
+        }
+        detail::push_range(acc_, first, last, 0);
+        buffer_.push_back(first, last);
+        const auto k = recompute_interval();
+        if(k > 0 && evictions_ >= k) {
+            recompute();
+        }
     }
 
 
     //---------------------------------------------------------------
     void
     pop() {
-        if(!queue_.empty()) {
-            acc_ -= queue_.front();
-            queue_.pop();
-        }
+        evict(1);
     }
 
 
@@ -121,12 +228,37 @@ public:
 
 
 private:
+    //---------------------------------------------------------------
+    static constexpr size_type
+    default_interval() noexcept {
+        return std::is_floating_point<argument_type>::value ? per_window : 0;
+    }
+    //-----------------------------------------------------
+    void
+    evict(size_type n) {
+        if(n > buffer_.size()) n = buffer_.size();
+        for(size_type i = 0; i < n; ++i) {
+            acc_ -= buffer_[i];
+        }
+        buffer_.pop_front(n);
+        evictions_ += n;
+    }
+
+
+    //---------------------------------------------------------------
     Accumulator acc_;
-    std::queue<argument_type> queue_;
+    ring_buffer<argument_type> buffer_;
     size_type windowSize_;
+    size_type rebuildInterval_;
+    size_type evictions_;
 };
 
 
+template<class Accumulator>
+constexpr typename windowed<Accumulator>::size_type
+windowed<Accumulator>::per_window;
+
+
 
 
 
@@ -153,10 +285,12 @@ public:
         acc_{}, buffer_{}
     {}
     //-----------------------------------------------------
-    explicit constexpr
+    explicit
     fixed_windowed(const argument_type& init):
-        acc_{init}, buffer_{init}
-    {}
+        acc_{}, buffer_{}
+    {
+        push(init);
+    }
 
     //-----------------------------------------------------
     fixed_windowed(const fixed_windowed&) = default;
@@ -184,9 +318,8 @@ public:
     //-----------------------------------------------------
     fixed_windowed&
     operator = (const argument_type& x) {
-        acc_ = x;
-        buffer_.clear();
-        buffer_.push(x);
+        clear();
+        push(x);
         return *this;
     }
 
@@ -213,6 +346,33 @@ public:
         acc_ += x;
         buffer_.push_back(x);
     }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return buffer_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return buffer_.empty();
+    }
+    //-----------------------------------------------------
+    /// @brief samples in the window (oldest to newest)
+    const window_buffer<argument_type,windowSize>&
+    values() const noexcept {
+        return buffer_;
+    }
 
 
     //---------------------------------------------------------------
@@ -0,0 +1,328 @@
+#ifndef AMLIB_STATISTICS_WINDOWED_HISTOGRAM_H_
+#define AMLIB_STATISTICS_WINDOWED_HISTOGRAM_H_
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#include "uniform_histogram.h"
+#include "nonuniform_histogram.h"
+#include "ring_buffer.h"
+
+
+namespace am {
+namespace stat {
+
+namespace detail {
+
+//-------------------------------------------------------------------
+template<class Argument, class Bins>
+inline decltype(auto)
+bin_count(uniform_histogram<Argument,Bins>& h, std::size_t i) {
+    return (h[i]);
+}
+
+template<class Argument, class Count>
+inline decltype(auto)
+bin_count(nonuniform_histogram<Argument,Count>& h, std::size_t i) {
+    return (h[i].second);
+}
+
+//---------------------------------------------------------
+template<class Argument, class Bins>
+inline decltype(auto)
+bin_count(const uniform_histogram<Argument,Bins>& h, std::size_t i) {
+    return (h[i]);
+}
+
+template<class Argument, class Count>
+inline decltype(auto)
+bin_count(const nonuniform_histogram<Argument,Count>& h, std::size_t i) {
+    return (h[i].second);
+}
+
+} // namespace detail
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief histogram of the n latest samples
+ *
+ * @details remembers the bin index of each sample in the window;
+ *          evicting a sample decrements its bin,
+ *          so insertion is O(1) (plus the histogram's bin lookup)
+ *          and memory is bounded by the window size
+ *
+ * @tparam Histogram  uniform_histogram or nonuniform_histogram
+ *
+ *****************************************************************************/
+template<class Histogram>
+class windowed_histogram
+{
+public:
+    //---------------------------------------------------------------
+    using histogram_type = Histogram;
+    using result_type    = Histogram;
+    using argument_type  = typename Histogram::argument_type;
+    using count_type     = typename Histogram::count_type;
+    using size_type      = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    windowed_histogram(histogram_type hist, size_type windowSize = 10):
+        hist_(std::move(hist)),
+        slots_(windowSize), windowSize_(windowSize > 0 ? windowSize : 1)
+    {
+        hist_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    window_size() const noexcept {
+        return windowSize_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return slots_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return slots_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        hist_.clear();
+        slots_.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    windowed_histogram&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        if(slots_.size() >= windowSize_) pop();
+
+        const auto i = hist_.index(x);
+        if(i < hist_.size()) ++detail::bin_count(hist_, i);
+
+        slots_.push_back(i);
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator begin, InputIterator end) {
+        for(; begin != end; ++begin) {
+            push(*begin);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief removes the oldest sample from the window
+    void
+    pop() {
+        if(slots_.empty()) return;
+
+        const auto i = slots_.front();
+        if(i < hist_.size()) --detail::bin_count(hist_, i);
+
+        slots_.pop_front();
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    result() const noexcept {
+        return hist_;
+    }
+
+
+private:
+    histogram_type hist_;
+    am::ring_buffer<size_type> slots_;
+    size_type windowSize_;
+};
+
+
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief histogram of all samples of the last n time intervals
+ *
+ * @details keeps one sub-histogram per interval (pane) and their sum;
+ *          a sample increments one bin in its pane and in the sum;
+ *          when time advances past a pane boundary the expired panes are
+ *          subtracted from the sum and recycled
+ *          (O(#bins) per interval, not per sample)
+ *
+ * @tparam Histogram  uniform_histogram or nonuniform_histogram
+ *
+ *****************************************************************************/
+template<class Histogram, class Time = double>
+class interval_windowed_histogram
+{
+public:
+    //---------------------------------------------------------------
+    using histogram_type = Histogram;
+    using result_type    = Histogram;
+    using argument_type  = typename Histogram::argument_type;
+    using count_type     = typename Histogram::count_type;
+    using time_type      = Time;
+    using size_type      = std::size_t;
+
+
+    //---------------------------------------------------------------
+    /**
+     * @param hist       defines the bins
+     * @param interval   duration of one pane
+     * @param intervals  number of panes in the window
+     *                   (the window spans interval * intervals)
+     */
+    explicit
+    interval_windowed_histogram(histogram_type hist,
+                                time_type interval, size_type intervals,
+                                time_type start = time_type(0))
+    :
+        sum_(std::move(hist)),
+        panes_(intervals > 0 ? intervals : 1, sum_),
+        interval_(interval), paneStart_(start), cur_(0)
+    {
+        sum_.clear();
+        for(auto& p : panes_) p.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    intervals() const noexcept {
+        return panes_.size();
+    }
+    //-----------------------------------------------------
+    const time_type&
+    interval() const noexcept {
+        return interval_;
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        sum_.clear();
+        for(auto& p : panes_) p.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief advances the current time; earlier times are ignored
+    void
+    advance(const time_type& now) {
+        if(!(interval_ > time_type(0)) || now < paneStart_ + interval_) return;
+
+        const auto steps = static_cast<size_type>((now - paneStart_) / interval_);
+        paneStart_ += interval_ * time_type(steps);
+
+        if(steps >= panes_.size()) {
+            clear();
+            cur_ = 0;
+            return;
+        }
+        for(size_type s = 0; s < steps; ++s) {
+            if(++cur_ >= panes_.size()) cur_ = 0;
+            expire(panes_[cur_]);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    interval_windowed_histogram&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    /// @brief inserts x into the current interval
+    void
+    push(const argument_type& x) {
+        const auto i = sum_.index(x);
+        if(i < sum_.size()) {
+            ++detail::bin_count(panes_[cur_], i);
+            ++detail::bin_count(sum_, i);
+        }
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator begin, InputIterator end) {
+        for(; begin != end; ++begin) {
+            push(*begin);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    result() const noexcept {
+        return sum_;
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    void
+    expire(histogram_type& pane) {
+        for(size_type i = 0; i < sum_.size(); ++i) {
+            detail::bin_count(sum_, i) -= detail::bin_count(pane, i);
+        }
+        pane.clear();
+    }
+
+
+    //---------------------------------------------------------------
+    histogram_type sum_;
+    std::vector<histogram_type> panes_;
+    time_type interval_;
+    time_type paneStart_;
+    size_type cur_;
+};
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Histogram>
+inline decltype(auto)
+result(const windowed_histogram<Histogram>& h) {
+    return h.result();
+}
+
+template<class Histogram, class Time>
+inline decltype(auto)
+result(const interval_windowed_histogram<Histogram,Time>& h) {
+    return h.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef AMLIB_STATISTICS_WINDOWED_MIN_MAX_H_
+#define AMLIB_STATISTICS_WINDOWED_MIN_MAX_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "ring_buffer.h"
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief best value (according to a comparator) of the n latest samples
+ *
+ * @details monotonic deque: keeps only samples that can still become the
+ *          best one, ordered by age; amortized O(1) per sample;
+ *          the deque never holds more than n entries and lives in a
+ *          ring buffer that is allocated once on construction
+ *
+ ****************************************************************************/
+template<
+    class Arg,
+    class Comparator
+>
+class windowed_comparative_accumulator
+{
+    using entry_t = std::pair<std::uint_least64_t,Arg>;
+
+public:
+    //---------------------------------------------------------------
+    using comparator    = Comparator;
+    using argument_type = Arg;
+    using result_type   = Arg;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    windowed_comparative_accumulator(size_type windowSize = 10,
+                                     const comparator& comp = comparator{})
+    :
+        deque_(windowSize > 0 ? windowSize : 1),
+        windowSize_(windowSize > 0 ? windowSize : 1),
+        n_(0), comp_(comp)
+    {}
+
+
+    //---------------------------------------------------------------
+    size_type
+    window_size() const noexcept {
+        return windowSize_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return (n_ < windowSize_) ? size_type(n_) : windowSize_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return deque_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        deque_.clear();
+        n_ = 0;
+    }
+    //-----------------------------------------------------
+    windowed_comparative_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    windowed_comparative_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        //evict expired sample
+        if(!deque_.empty() && deque_.front().first + windowSize_ <= n_) {
+            deque_.pop_front();
+        }
+        //samples that are not better than x can never be the result again
+        while(!deque_.empty() && !comp_(deque_.back().second, x)) {
+            deque_.pop_back();
+        }
+        deque_.push_back(entry_t{n_, x});
+        ++n_;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief undefined if empty
+    const result_type&
+    result() const {
+        return deque_.front().second;
+    }
+
+
+private:
+    am::ring_buffer<entry_t> deque_;
+    size_type windowSize_;
+    std::uint_least64_t n_;
+    comparator comp_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *
+ *****************************************************************************/
+template<class Arg>
+using windowed_min_accumulator =
+    windowed_comparative_accumulator<Arg,std::less<Arg>>;
+
+template<class Arg>
+using windowed_max_accumulator =
+    windowed_comparative_accumulator<Arg,std::greater<Arg>>;
+
+
+
+
+/*************************************************************************//***
+ *
+ * @brief minimum and maximum of the n latest samples
+ *
+ ****************************************************************************/
+template<class Arg>
+class windowed_min_max_accumulator
+{
+public:
+    //---------------------------------------------------------------
+    using argument_type = Arg;
+    using result_type   = Arg;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    windowed_min_max_accumulator(size_type windowSize = 10):
+        min_(windowSize), max_(windowSize)
+    {}
+
+
+    //---------------------------------------------------------------
+    size_type
+    window_size() const noexcept {
+        return min_.window_size();
+    }
+    //-----------------------------------------------------
+    size_type
+    size() const noexcept {
+        return min_.size();
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return min_.empty();
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        min_.clear();
+        max_.clear();
+    }
+    //-----------------------------------------------------
+    windowed_min_max_accumulator&
+    operator = (const argument_type& x) {
+        min_ = x;
+        max_ = x;
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    windowed_min_max_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        min_.push(x);
+        max_.push(x);
+    }
+    //-----------------------------------------------------
+    template<class InputIterator>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    const result_type&
+    min() const {
+        return min_.result();
+    }
+    //-----------------------------------------------------
+    const result_type&
+    max() const {
+        return max_.result();
+    }
+
+
+private:
+    windowed_min_accumulator<Arg> min_;
+    windowed_max_accumulator<Arg> max_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Comp>
+inline decltype(auto)
+result(const windowed_comparative_accumulator<Arg,Comp>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
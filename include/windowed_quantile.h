@@ -0,0 +1,293 @@
+#ifndef AMLIB_STATISTICS_WINDOWED_QUANTILE_H_
+#define AMLIB_STATISTICS_WINDOWED_QUANTILE_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <functional>
+#include <type_traits>
+
+
+namespace am {
+namespace stat {
+
+
+/*************************************************************************//***
+ *
+ * @brief order statistics (median, quantiles, k-th smallest value)
+ *        of the n latest samples
+ *
+ * @details indexable skip list: each link stores the number of positions
+ *          it skips, so insertion, eviction and rank queries
+ *          are all O(log n) (expected);
+ *          all n nodes live in one arena that is allocated on construction;
+ *          node i always holds the i-th sample modulo n, so the evicted
+ *          node is recycled for the new sample (together with its
+ *          randomly chosen height);
+ *          equal values are ordered by age
+ *
+ ****************************************************************************/
+template<
+    class Arg,
+    class Comparator = std::less<Arg>
+>
+class windowed_quantile_accumulator
+{
+    using seq_t = std::uint_least64_t;
+
+    struct link {
+        std::size_t next;
+        std::size_t width;
+    };
+
+public:
+    //---------------------------------------------------------------
+    using comparator    = Comparator;
+    using argument_type = Arg;
+    using result_type   = Arg;
+    using size_type     = std::size_t;
+
+
+    //---------------------------------------------------------------
+    explicit
+    windowed_quantile_accumulator(size_type windowSize = 10,
+                                  const comparator& comp = comparator{})
+    :
+        windowSize_(windowSize > 0 ? windowSize : 1),
+        maxLevel_(1), n_(0),
+        values_(windowSize_), seqs_(windowSize_ + 2, 0),
+        links_{}, offsets_{}, levels_{}, chain_{}, steps_{},
+        comp_(comp)
+    {
+        while((size_type(1) << maxLevel_) < windowSize_) ++maxLevel_;
+        chain_.resize(maxLevel_);
+        steps_.resize(maxLevel_);
+
+        //heights with geometric distribution (p = 1/2);
+        //fixed seed => reproducible performance
+        auto rnd = std::uint_least32_t(0x9e3779b9u);
+        offsets_.reserve(windowSize_ + 2);
+        levels_.reserve(windowSize_ + 2);
+        size_type ofs = 0;
+        for(size_type i = 0; i < windowSize_; ++i) {
+            rnd ^= rnd << 13; rnd ^= rnd >> 17; rnd ^= rnd << 5;
+            size_type lvl = 1;
+            for(auto r = rnd; (r & 1u) && lvl < maxLevel_; r >>= 1) ++lvl;
+            offsets_.push_back(ofs);
+            levels_.push_back(lvl);
+            ofs += lvl;
+        }
+        //head and tail sentinels span all levels
+        for(size_type i = 0; i < 2; ++i) {
+            offsets_.push_back(ofs);
+            levels_.push_back(maxLevel_);
+            ofs += maxLevel_;
+        }
+        links_.resize(ofs);
+        clear();
+    }
+
+
+    //---------------------------------------------------------------
+    size_type
+    window_size() const noexcept {
+        return windowSize_;
+    }
+    //-----------------------------------------------------
+    /// @brief number of samples currently in the window
+    size_type
+    size() const noexcept {
+        return (n_ < windowSize_) ? size_type(n_) : windowSize_;
+    }
+    //-----------------------------------------------------
+    bool
+    empty() const noexcept {
+        return (n_ < 1);
+    }
+
+
+    //---------------------------------------------------------------
+    void
+    clear() {
+        for(size_type l = 0; l < maxLevel_; ++l) {
+            lnk(head(), l) = link{tail(), 1};
+        }
+        n_ = 0;
+    }
+    //-----------------------------------------------------
+    windowed_quantile_accumulator&
+    operator = (const argument_type& x) {
+        clear();
+        push(x);
+        return *this;
+    }
+
+
+    //---------------------------------------------------------------
+    windowed_quantile_accumulator&
+    operator += (const argument_type& x) {
+        push(x);
+        return *this;
+    }
+    //-----------------------------------------------------
+    void
+    push(const argument_type& x) {
+        const auto node = size_type(n_ % windowSize_);
+        if(n_ >= windowSize_) erase(node);
+        values_[node] = x;
+        seqs_[node] = n_;
+        insert(node);
+        ++n_;
+    }
+    //-----------------------------------------------------
+    template<class InputIterator, class = std::enable_if_t<
+        !std::is_convertible<InputIterator,argument_type>::value>>
+    void
+    push(InputIterator first, InputIterator last) {
+        for(; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    /// @brief k-th smallest value in the window (0-based); k < size()
+    const argument_type&
+    nth(size_type k) const noexcept {
+        auto node = head();
+        auto i = k + 1;
+        for(auto l = maxLevel_; l > 0; --l) {
+            while(lnk(node, l-1).width <= i) {
+                i -= lnk(node, l-1).width;
+                node = lnk(node, l-1).next;
+            }
+        }
+        return values_[node];
+    }
+    //-----------------------------------------------------
+    /// @brief smallest value v such that at least q*size() values are <= v
+    ///        (nearest rank); undefined if empty
+    const argument_type&
+    quantile(double q) const noexcept {
+        const auto n = size();
+        if(!(q > 0)) return nth(0);
+        const auto k = size_type(std::ceil(q * double(n)));
+        return nth(k > 0 ? ((k < n) ? k-1 : n-1) : 0);
+    }
+    //-----------------------------------------------------
+    /// @brief lower median; undefined if empty
+    const argument_type&
+    median() const noexcept {
+        return nth((size() - 1) / 2);
+    }
+    //-----------------------------------------------------
+    const result_type&
+    result() const noexcept {
+        return median();
+    }
+
+
+private:
+    //---------------------------------------------------------------
+    size_type head() const noexcept { return windowSize_; }
+    size_type tail() const noexcept { return windowSize_ + 1; }
+
+    link& lnk(size_type node, size_type level) noexcept {
+        return links_[offsets_[node] + level];
+    }
+    const link& lnk(size_type node, size_type level) const noexcept {
+        return links_[offsets_[node] + level];
+    }
+
+    //-----------------------------------------------------
+    /// @brief strict total order on (value,age); tail is +infinity
+    bool
+    before(size_type a, size_type b) const noexcept {
+        if(a == tail()) return false;
+        if(comp_(values_[a], values_[b])) return true;
+        if(comp_(values_[b], values_[a])) return false;
+        return seqs_[a] < seqs_[b];
+    }
+
+    //-----------------------------------------------------
+    /// @brief finds the last node before 'key' on each level
+    void
+    find_chain(size_type key) noexcept {
+        auto node = head();
+        for(auto l = maxLevel_; l > 0; --l) {
+            steps_[l-1] = 0;
+            while(before(lnk(node, l-1).next, key)) {
+                steps_[l-1] += lnk(node, l-1).width;
+                node = lnk(node, l-1).next;
+            }
+            chain_[l-1] = node;
+        }
+    }
+
+    //-----------------------------------------------------
+    void
+    insert(size_type node) noexcept {
+        find_chain(node);
+        const auto d = levels_[node];
+        size_type steps = 0;
+        for(size_type l = 0; l < d; ++l) {
+            auto& prev = lnk(chain_[l], l);
+            lnk(node, l) = link{prev.next, prev.width - steps};
+            prev = link{node, steps + 1};
+            steps += steps_[l];
+        }
+        for(size_type l = d; l < maxLevel_; ++l) {
+            ++lnk(chain_[l], l).width;
+        }
+    }
+
+    //-----------------------------------------------------
+    void
+    erase(size_type node) noexcept {
+        find_chain(node);
+        const auto d = levels_[node];
+        for(size_type l = 0; l < d; ++l) {
+            auto& prev = lnk(chain_[l], l);
+            prev.width += lnk(node, l).width - 1;
+            prev.next = lnk(node, l).next;
+        }
+        for(size_type l = d; l < maxLevel_; ++l) {
+            --lnk(chain_[l], l).width;
+        }
+    }
+
+
+    //---------------------------------------------------------------
+    size_type windowSize_;
+    size_type maxLevel_;
+    seq_t n_;
+    std::vector<argument_type> values_;
+    std::vector<seq_t> seqs_;
+    std::vector<link> links_;
+    std::vector<size_type> offsets_;
+    std::vector<size_type> levels_;
+    std::vector<size_type> chain_;
+    std::vector<size_type> steps_;
+    comparator comp_;
+};
+
+
+
+
+/*****************************************************************************
+ *
+ *
+ *****************************************************************************/
+template<class Arg, class Comp>
+inline decltype(auto)
+result(const windowed_quantile_accumulator<Arg,Comp>& a) {
+    return a.result();
+}
+
+
+} //namespace stat
+}  // namespace am
+
+
+#endif
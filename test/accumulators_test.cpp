@@ -15,9 +15,17 @@
 #include "current.h"
 #include "moments.h"
 #include "min_max_moments.h"
+#include "k_best.h"
 
 #include <iostream>
 #include <vector>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <cstdint>
 
 
 using namespace am::stat;
@@ -116,6 +124,137 @@ void fp_accumulation()
 
 
 
+//-------------------------------------------------------------------
+template<class T>
+void merging()
+{
+    using std::abs;
+    constexpr auto eps = 0.001;
+
+    auto v = std::vector<T>{
+        1, 2, 3, 10, 11, T(2.5), 3, 4, T(6.6), T(8.92), T(15.1), 18, 13, 14};
+
+    moments_accumulator<T,4> all, a, b;
+    min_max_moments_accumulator<T,2> mmA, mmB;
+    initial_value_accumulator<T> iniA, iniB;
+    current_value_accumulator<T> curA, curB;
+
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        all += v[i];
+        if(i < 5) {
+            a += v[i]; mmA += v[i]; iniA += v[i]; curA += v[i];
+        } else {
+            b += v[i]; mmB += v[i]; iniB += v[i]; curB += v[i];
+        }
+    }
+    a.merge(b);
+    mmA.merge(mmB);
+    iniA.merge(iniB);
+    curA.merge(curB);
+
+    if(!(  (a.size() == all.size())
+        && (abs(a.mean() - all.mean()) < eps)
+        && (abs(a.variance() - all.variance()) < eps)
+        && (abs(a.central_moment_3() - all.central_moment_3()) < eps)
+        && (abs(a.sum_4() - all.sum_4()) < eps)
+        && (abs(mmA.min() - 1) < eps)
+        && (abs(mmA.max() - 18) < eps)
+        && (abs(mmA.mean() - all.mean()) < eps)
+        && (abs(iniA.result() - 1) < eps)
+        && (abs(curA.result() - 14) < eps) ))
+    {
+        throw std::logic_error("accumulator merge results");
+    }
+}
+
+//-------------------------------------------------------------------
+template<class Acc, class It>
+auto has_range_push(int)
+    -> decltype(std::declval<Acc&>().push(std::declval<It>(), std::declval<It>()),
+                std::true_type{});
+
+template<class Acc, class It>
+std::false_type has_range_push(long);
+
+
+//-------------------------------------------------------------------
+void bulk_push()
+{
+    using acc_t = moments_accumulator<double,4>;
+
+    //single-pass input iterators must not be traversed once per level
+    static_assert(!decltype(has_range_push<acc_t,
+        std::istream_iterator<double>>(0))::value,
+        "moments range push must require forward iterators");
+
+    const auto l = std::list<double>{1, 2, 3.5, -4, 8};
+    acc_t bulk, single;
+    bulk.push(l.begin(), l.end());
+    for(auto x : l) single += x;
+
+    if(!(  (bulk.size() == single.size())
+        && (bulk.sum_4() == single.sum_4())
+        && (bulk.variance() == single.variance()) ))
+    {
+        throw std::logic_error("moments bulk push");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+/// @brief k = 5 uses the sorted array, k = 100 the heap
+void k_best(std::size_t k)
+{
+    auto urng = std::mt19937_64{k};
+    auto distr = std::exponential_distribution<double>{0.01};
+
+    //latencies with request ids
+    using entry = std::pair<double,int>;
+    auto v = std::vector<entry>{};
+    for(int i = 0; i < 10000; ++i) v.emplace_back(distr(urng), i);
+
+    auto expected = v;
+    std::sort(expected.begin(), expected.end(), std::greater<entry>{});
+    expected.resize(k);
+
+    top_k_accumulator<entry> single{k}, bulk{k}, a{k}, b{k};
+    for(const auto& x : v) single += x;
+    bulk.push(v.begin(), v.end());
+    a.push(v.begin(), v.begin() + 3000);
+    b.push(v.begin() + 3000, v.end());
+    a.merge(b);
+
+    if(single.result() != expected || bulk.result() != expected ||
+       a.result() != expected || single.size() != k)
+    {
+        throw std::logic_error("top_k_accumulator result");
+    }
+    if(single.best() != expected.front() || single.worst() != expected.back()) {
+        throw std::logic_error("top_k_accumulator best/worst");
+    }
+
+    //bottom-k with duplicates
+    auto w = std::vector<int>{};
+    for(int i = 0; i < 1000; ++i) w.push_back(int(i * 7919 % 101));
+    bottom_k_accumulator<int> low{k};
+    low.push(w.begin(), w.end());
+    std::sort(w.begin(), w.end());
+    w.resize(k);
+    if(low.result() != w) throw std::logic_error("bottom_k_accumulator result");
+
+    //fewer values than k
+    bottom_k_accumulator<int> few{k};
+    few += 3; few += 1; few += 2;
+    if(few.full() || few.result() != std::vector<int>{1, 2, 3}) {
+        throw std::logic_error("bottom_k_accumulator partial result");
+    }
+    few.clear();
+    if(!few.empty()) throw std::logic_error("bottom_k_accumulator clear");
+}
+
+
+
 //-------------------------------------------------------------------
 int main()
 {
@@ -123,6 +262,11 @@ int main()
         fp_accumulation<float>();
         fp_accumulation<double>();
         fp_accumulation<long double>();
+        merging<float>();
+        merging<double>();
+        bulk_push();
+        k_best(5);
+        k_best(100);
     }
     catch(std::exception& e) {
         std::cerr << "wrong " << e.what();
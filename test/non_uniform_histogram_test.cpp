@@ -13,6 +13,8 @@
 #include <iostream>
 #include <random>
 #include <functional>
+#include <vector>
+#include <cmath>
 
 
 
@@ -32,6 +34,38 @@ int main()
         h.insert(x);
     }
 
+    if(h.total() > 1000) return 1;
+
+    auto wh = am::stat::nonuniform_histogram<double,double>{
+        0.0, 1.0, 10.0, 100.0};
+
+    auto v = std::vector<double>{0.5, 5.0, 50.0, 9.0, -1.0};
+    auto w = std::vector<double>{1.5, 0.25, 4.0, 0.75, 8.0};
+    wh.insert(v.begin(), v.end(), w.begin());
+    wh.insert(10.0, 2.0);
+
+    if( !( (wh[0].second == 1.5)
+        && (wh[1].second == 1.0)
+        && (wh[2].second == 6.0)
+        && (wh.total() == 8.5) ))
+    {
+        std::cerr << "wrong nonuniform_histogram weighted result";
+        return 1;
+    }
+
+    const auto view = normalized(wh);
+    auto freq = std::vector<double>(wh.size());
+    relative_frequencies(wh, freq.begin());
+
+    for(std::size_t i = 0; i < wh.size(); ++i) {
+        if(std::abs(view[i] - wh[i].second / 8.5) > 0.0001 ||
+           std::abs(freq[i] - view[i]) > 0.0001)
+        {
+            std::cerr << "wrong nonuniform_histogram relative frequencies";
+            return 1;
+        }
+    }
+
 //    std::cout << h.size() << " " << h.total() <<"\n"<< pretty(h) << std::endl;
 
 }
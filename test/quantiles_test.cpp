@@ -0,0 +1,571 @@
+/*****************************************************************************
+ *
+ * AM utilities
+ *
+ * released under MIT license
+ *
+ * 2008-2016 André Müller
+ *
+ *****************************************************************************/
+
+#include "quantile.h"
+#include "tdigest.h"
+#include "kll.h"
+#include "p2_quantile.h"
+#include "ddsketch.h"
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <thread>
+#include <new>
+
+
+using namespace am::stat;
+
+
+//-------------------------------------------------------------------
+/// @brief exact quantile by nearest rank
+double exact_quantile(std::vector<double> v, double q)
+{
+    std::sort(v.begin(), v.end());
+    const auto k = std::size_t(std::ceil(q * double(v.size())));
+    return v[k > 0 ? k-1 : 0];
+}
+
+
+
+//-------------------------------------------------------------------
+/// @brief fraction of values that are <= x
+double rank_of(std::vector<double> v, double x)
+{
+    std::sort(v.begin(), v.end());
+    const auto n = std::upper_bound(v.begin(), v.end(), x) - v.begin();
+    return double(n) / double(v.size());
+}
+
+
+
+//-------------------------------------------------------------------
+/// @brief exact quantile by sorting with linear interpolation
+double sorted_quantile(std::vector<double> v, double q)
+{
+    std::sort(v.begin(), v.end());
+    const auto h = (v.size() - 1) * q;
+    const auto k = std::size_t(h);
+    if(k + 1 >= v.size()) return v.back();
+    return v[k] + (h - double(k)) * (v[k+1] - v[k]);
+}
+
+
+
+//-------------------------------------------------------------------
+/// @brief value whose copies fail outside of the main thread
+struct main_thread_only
+{
+    static std::thread::id main;
+
+    double x = 0;
+
+    main_thread_only() = default;
+    main_thread_only(double v): x(v) {}
+    main_thread_only(const main_thread_only& o): x(o.x) {
+        if(std::this_thread::get_id() != main) throw std::bad_alloc{};
+    }
+    main_thread_only& operator = (const main_thread_only&) = default;
+
+    friend bool operator < (const main_thread_only& a, const main_thread_only& b) {
+        return a.x < b.x;
+    }
+    friend main_thread_only operator + (main_thread_only a, const main_thread_only& b) {
+        return a.x + b.x;
+    }
+    friend main_thread_only operator - (main_thread_only a, const main_thread_only& b) {
+        return a.x - b.x;
+    }
+    friend main_thread_only operator * (main_thread_only a, double f) {
+        return a.x * f;
+    }
+};
+std::thread::id main_thread_only::main = std::this_thread::get_id();
+
+
+//-------------------------------------------------------------------
+void test_exact_quantiles()
+{
+    using std::abs;
+
+    const auto i = std::vector<int>{7, 1, 3, 9, 5, 3};
+    if(median(i.begin(), i.end()) != 4.0 ||
+       quantile(i.begin(), i.end(), 0) != 1.0 ||
+       quantile(i.begin(), i.end(), 1) != 9.0 ||
+       quantile(i.begin(), i.end(), 0.2) != 3.0)
+    {
+        throw std::logic_error("quantile (int)");
+    }
+
+    auto rnd = std::mt19937{};
+    auto distr = std::uniform_real_distribution<double>{-100, 100};
+    auto v = std::vector<double>(1001);
+    for(auto& x : v) x = distr(rnd);
+
+    const auto qs = quantiles(v.begin(), v.end(), {0.999, 0.5, 0.1, 0.9, 0.0, 0.25});
+    const auto qv = std::vector<double>{0.999, 0.5, 0.1, 0.9, 0.0, 0.25};
+    for(std::size_t j = 0; j < qv.size(); ++j) {
+        if(abs(qs[j] - sorted_quantile(v, qv[j])) > 1e-9 ||
+           abs(quantile(v.begin(), v.end(), qv[j]) - qs[j]) > 1e-9)
+        {
+            throw std::logic_error("quantiles");
+        }
+    }
+
+    //in-place
+    auto w = v;
+    const auto med = median_inplace(w.begin(), w.end());
+    if(med != w[500] || med != sorted_quantile(v, 0.5) ||
+       std::any_of(w.begin(), w.begin() + 500, [&](double x) { return x > med; }))
+    {
+        throw std::logic_error("median_inplace");
+    }
+    const auto qi = quantiles_inplace(w.begin(), w.end(), {0.25, 0.75});
+    if(qi[0] != sorted_quantile(v, 0.25) || qi[1] != sorted_quantile(v, 0.75)) {
+        throw std::logic_error("quantiles_inplace");
+    }
+
+    //parallel
+    auto big = std::vector<double>(200000);
+    for(auto& x : big) x = distr(rnd);
+    for(double q : {0.0, 0.001, 0.5, 0.77, 1.0}) {
+        if(abs(quantile_parallel(big.begin(), big.end(), q, 4) -
+               sorted_quantile(big, q)) > 1e-9)
+        {
+            throw std::logic_error("quantile_parallel");
+        }
+    }
+    //many duplicates
+    for(auto& x : big) x = std::floor(x / 50);
+    if(median_parallel(big.begin(), big.end(), 3) != sorted_quantile(big, 0.5)) {
+        throw std::logic_error("median_parallel");
+    }
+
+    //failing worker threads => sequential fallback
+    auto odd = std::vector<main_thread_only>{};
+    for(int i = 0; i < 70001; ++i) odd.emplace_back(double((i * 7919) % 70001));
+    if(median_parallel(odd.begin(), odd.end(), 4).x != 35000.0) {
+        throw std::logic_error("median_parallel (failing workers)");
+    }
+
+    const auto e = std::vector<double>{};
+    if(median(e.begin(), e.end()) != 0.0) {
+        throw std::logic_error("median (empty)");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_tdigest()
+{
+    using std::abs;
+
+    auto rnd = std::mt19937{};
+    auto distr = std::lognormal_distribution<double>{0, 1};
+
+    //64 shards, merged for global quantiles
+    auto shards = std::vector<tdigest_accumulator<double>>(64);
+    auto all = tdigest_accumulator<double>{};
+    auto v = std::vector<double>{};
+    for(int i = 0; i < 64000; ++i) {
+        const auto x = distr(rnd);
+        v.push_back(x);
+        shards[i % 64] += x;
+        all += x;
+    }
+    auto global = tdigest_accumulator<double>{};
+    for(const auto& s : shards) global.merge(s);
+
+    for(const auto& d : {all, global}) {
+        if(d.size() != v.size() || d.centroid_count() > 2 * d.compression()) {
+            throw std::logic_error("tdigest size");
+        }
+        if( !( (d.min() == *std::min_element(v.begin(), v.end()))
+            && (d.max() == *std::max_element(v.begin(), v.end())) ))
+        {
+            throw std::logic_error("tdigest min/max");
+        }
+        //rank error
+        for(double q : {0.5, 0.9, 0.99}) {
+            if(abs(rank_of(v, d.quantile(q)) - q) > 0.005) {
+                throw std::logic_error("tdigest quantile");
+            }
+        }
+        if(abs(rank_of(v, d.quantile(0.999)) - 0.999) > 0.0005) {
+            throw std::logic_error("tdigest tail quantile");
+        }
+    }
+
+    //const queries don't modify the digest; compress() gives the same answers
+    {
+        auto tmp = all;
+        tmp += 1.0;     //non-empty insert buffer
+        const auto c = tmp;
+        const auto q99 = c.quantile(0.99);
+        const auto n = c.centroid_count();
+        auto f = c;
+        f.compress();
+        if(c.quantile(0.99) != q99 || f.quantile(0.99) != q99 ||
+           f.centroid_count() != n)
+        {
+            throw std::logic_error("tdigest const queries");
+        }
+    }
+
+    //bulk & weighted insertion
+    auto b = tdigest_accumulator<double>{};
+    const auto w = std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    b.push(w.begin(), w.end());
+    b.push(10.0, 9);
+    if(b.size() != 18 || abs(b.median() - exact_quantile(w, 1.0)) > 0.5) {
+        throw std::logic_error("tdigest weighted");
+    }
+
+    b.clear();
+    if(!b.empty() || b.quantile(0.5) != 0.0) {
+        throw std::logic_error("tdigest clear");
+    }
+    b = 3.0;
+    if(b.quantile(0.2) != 3.0) {
+        throw std::logic_error("tdigest single value");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_kll()
+{
+    using std::abs;
+
+    auto rnd = std::mt19937{};
+    auto distr = std::exponential_distribution<double>{1};
+
+    auto v = std::vector<double>(100000);
+    for(auto& x : v) x = distr(rnd);
+
+    auto a = kll_accumulator<double>{};
+    for(auto x : v) a += x;
+
+    //bulk push; same seed => same sketch
+    auto b = kll_accumulator<double>{};
+    b.push(v.begin(), v.end());
+
+    //merged shards
+    auto m = kll_accumulator<double>{};
+    for(std::size_t s = 0; s < 10; ++s) {
+        auto part = kll_accumulator<double>{200, 1000 + s};
+        part.push(v.begin() + s * 10000, v.begin() + (s+1) * 10000);
+        m.merge(part);
+    }
+
+    const auto eps = a.normalized_rank_error();
+    for(const auto* k : {&a, &b, &m}) {
+        if(k->size() != v.size() || k->retained() > 3 * k->k()) {
+            throw std::logic_error("kll size");
+        }
+        for(double q : {0.01, 0.25, 0.5, 0.9, 0.99}) {
+            if(abs(rank_of(v, k->quantile(q)) - q) > eps) {
+                throw std::logic_error("kll quantile");
+            }
+            if(abs(k->rank(exact_quantile(v, q)) - q) > eps) {
+                throw std::logic_error("kll rank");
+            }
+        }
+    }
+    if(a.quantile(0.5) != b.quantile(0.5) || a.retained() != b.retained()) {
+        throw std::logic_error("kll bulk push / reproducibility");
+    }
+    if(a.min() != *std::min_element(v.begin(), v.end()) ||
+       a.max() != *std::max_element(v.begin(), v.end()))
+    {
+        throw std::logic_error("kll min/max");
+    }
+    if(a.memory_usage() < a.retained() * sizeof(double)) {
+        throw std::logic_error("kll memory usage");
+    }
+
+    //const queries don't modify the sketch; prepare() gives the same answers
+    {
+        const auto c = a;
+        const auto q9 = c.quantile(0.9);
+        const auto r9 = c.rank(q9);
+        auto p = c;
+        p.prepare();
+        if(c.quantile(0.9) != q9 || p.quantile(0.9) != q9 || p.rank(q9) != r9) {
+            throw std::logic_error("kll const queries");
+        }
+        p += 1e9;       //invalidates the prepared view
+        if(p.quantile(1.0 - 0.5 / double(p.size())) != 1e9) {
+            throw std::logic_error("kll prepared view after push");
+        }
+    }
+
+    //serialization round trip
+    std::stringstream ss;
+    a.write(ss);
+    auto r = kll_accumulator<double>{};
+    if(!r.read(ss) || r.size() != a.size() || r.retained() != a.retained() ||
+       r.quantile(0.9) != a.quantile(0.9))
+    {
+        throw std::logic_error("kll serialization");
+    }
+    std::stringstream bad{"garbage"};
+    if(r.read(bad) || !r.empty()) {
+        throw std::logic_error("kll deserialization of invalid input");
+    }
+
+    //corrupted serializations
+    const auto good = [&]{ std::stringstream os; a.write(os); return os.str(); }();
+    //header: magic, value size, k, n, seed, rnd, min, max, #levels
+    const std::size_t nOfs = 4 + 4 + 2;
+    const std::size_t nlOfs = nOfs + 8 + 8 + 8 + 2 * sizeof(double);
+    std::uint32_t nl = 0;
+    std::copy_n(good.data() + nlOfs, 4, reinterpret_cast<char*>(&nl));
+    auto sizes = std::vector<std::uint32_t>(nl);
+    std::copy_n(good.data() + nlOfs + 4, 4 * nl, reinterpret_cast<char*>(sizes.data()));
+
+    auto rejects = [](const std::string& str) {
+        std::stringstream is{str};
+        auto s = kll_accumulator<double>{100};
+        return !s.read(is) && s.empty() && s.k() == 100;
+    };
+
+    //huge level size that matches n, but no data => no giant allocation
+    {
+        auto str = good.substr(0, nlOfs);
+        const std::uint64_t n = 0xfffffff0u;
+        const std::uint32_t one = 1;
+        str.replace(nOfs, 8, reinterpret_cast<const char*>(&n), 8);
+        str.append(reinterpret_cast<const char*>(&one), 4);
+        str.append(reinterpret_cast<const char*>(&n), 4);
+        if(!rejects(str)) throw std::logic_error("kll read: truncated levels");
+    }
+    //level weights don't add up to n
+    {
+        auto str = good;
+        auto n = a.size() + 1;
+        str.replace(nOfs, 8, reinterpret_cast<const char*>(&n), 8);
+        if(!rejects(str)) throw std::logic_error("kll read: weight sum");
+    }
+    //unsorted level (first level above 0 with at least 2 distinct items)
+    {
+        auto ofs = nlOfs + 4 + 4 * nl + sizes[0] * sizeof(double);
+        std::size_t h = 1;
+        for(; h < nl && sizes[h] < 2; ++h) ofs += sizes[h] * sizeof(double);
+        if(h == nl) throw std::logic_error("kll read: test expects a sorted level");
+        auto str = good;
+        std::swap_ranges(str.begin() + ofs, str.begin() + ofs + 8,
+                         str.begin() + ofs + 8 * (sizes[h] - 1));
+        if(!rejects(str)) throw std::logic_error("kll read: unsorted level");
+    }
+    if(rejects(good)) throw std::logic_error("kll read: valid input rejected");
+}
+
+
+
+//-------------------------------------------------------------------
+void test_p2_quantile()
+{
+    using std::abs;
+    using acc_t = p2_quantile_accumulator<double,
+        std::ratio<1,2>, std::ratio<9,10>, std::ratio<99,100>>;
+
+    static_assert(sizeof(acc_t) <= 200, "P2 accumulator should be small");
+
+    auto a = acc_t{};
+    auto m = p2_median_accumulator<int>{};
+
+    //exact for few samples
+    for(int x : {5, 1, 4}) {
+        a += x;
+        m += x;
+    }
+    if(a.quantile<0>() != 4 || a.max() != 5 || a.min() != 1 || m.result() != 4) {
+        throw std::logic_error("p2_quantile_accumulator initial samples");
+    }
+
+    auto rnd = std::mt19937{};
+    auto distr = std::normal_distribution<double>{10, 2};
+    auto v = std::vector<double>{5, 1, 4};
+    for(int i = 0; i < 100000; ++i) {
+        const auto x = distr(rnd);
+        v.push_back(x);
+        a += x;
+    }
+    const auto q = a.quantiles();
+    for(std::size_t i = 0; i < acc_t::num_quantiles(); ++i) {
+        const auto p = acc_t::probability(i);
+        if(abs(rank_of(v, q[i]) - p) > 0.005) {
+            throw std::logic_error("p2_quantile_accumulator quantiles");
+        }
+    }
+    if(a.size() != v.size() ||
+       a.min() != *std::min_element(v.begin(), v.end()) ||
+       a.max() != *std::max_element(v.begin(), v.end()))
+    {
+        throw std::logic_error("p2_quantile_accumulator min/max");
+    }
+
+    a.clear();
+    if(!a.empty() || a.result() != 0) {
+        throw std::logic_error("p2_quantile_accumulator clear");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+template<class Sketch>
+void test_ddsketch_relative_error(const Sketch& d, std::vector<double> v)
+{
+    using std::abs;
+    std::sort(v.begin(), v.end());
+    for(double q : {0.001, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999}) {
+        const auto x = v[std::size_t(q * double(v.size() - 1))];
+        if(abs(d.quantile(q) - x) > d.relative_accuracy() * abs(x) * 1.0001) {
+            throw std::logic_error("ddsketch relative error");
+        }
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_ddsketch()
+{
+    auto rnd = std::mt19937{};
+    auto distr = std::lognormal_distribution<double>{0, 2};
+
+    auto dense  = ddsketch_accumulator<double>{0.01};
+    auto sparse = sparse_ddsketch_accumulator<double>{0.01};
+    auto merged = ddsketch_accumulator<double>{0.01};
+    auto part   = ddsketch_accumulator<double>{0.01};
+
+    auto v = std::vector<double>{};
+    for(int i = 0; i < 50000; ++i) {
+        //some negative values and zeros
+        const auto x = (i % 10 == 0) ? -distr(rnd) : ((i % 97 == 0) ? 0.0 : distr(rnd));
+        v.push_back(x);
+        dense += x;
+        sparse += x;
+        ((i % 2) ? merged : part) += x;
+    }
+    if(!merged.merge(part)) throw std::logic_error("ddsketch merge");
+
+    for(const auto& d : {dense, merged}) {
+        if(d.size() != v.size()) throw std::logic_error("ddsketch size");
+        test_ddsketch_relative_error(d, v);
+    }
+    test_ddsketch_relative_error(sparse, v);
+
+    if(dense.quantile(0) != *std::min_element(v.begin(), v.end()) ||
+       dense.quantile(1) != *std::max_element(v.begin(), v.end()))
+    {
+        throw std::logic_error("ddsketch min/max");
+    }
+    if(sparse.positive_store().buckets() > dense.positive_store().buckets()) {
+        throw std::logic_error("ddsketch sparse store");
+    }
+
+    //incompatible accuracy
+    if(dense.merge(ddsketch_accumulator<double>{0.05})) {
+        throw std::logic_error("ddsketch incompatible merge");
+    }
+
+    //collapsing keeps the upper quantiles accurate
+    auto c = ddsketch_accumulator<double>{0.01, 512};
+    auto cs = sparse_ddsketch_accumulator<double>{0.01, 512};
+    auto pv = std::vector<double>{};
+    for(const auto x : v) {
+        if(x > 0) pv.push_back(x);
+    }
+    c.push(pv.begin(), pv.end());
+    cs.push(pv.begin(), pv.end());
+    std::sort(pv.begin(), pv.end());
+    if(c.positive_store().buckets() > 512 || cs.positive_store().buckets() > 512) {
+        throw std::logic_error("ddsketch bucket limit");
+    }
+    if(c.quantile(0.001) < 2 * pv[std::size_t(0.001 * double(pv.size() - 1))]) {
+        throw std::logic_error("ddsketch collapsing expected");
+    }
+    const auto x99 = pv[std::size_t(0.99 * double(pv.size() - 1))];
+    if(std::abs(c.quantile(0.99) - x99) > 0.01 * x99 ||
+       std::abs(cs.quantile(0.99) - x99) > 0.01 * x99)
+    {
+        throw std::logic_error("ddsketch collapsed store");
+    }
+
+    //dense store grows geometrically; same buckets as the sparse store
+    auto ds = ddsketch_dense_store<>{4096};
+    std::size_t reallocs = 0;
+    for(int i = 0; i < 3000; ++i) {
+        const auto cap = ds.capacity();
+        ds.add(i);
+        ds.add(-i);
+        if(ds.capacity() != cap) ++reallocs;
+    }
+    if(reallocs > 30 || ds.capacity() > 2 * ds.max_buckets() ||
+       ds.buckets() != 4096 || ds.total() != 6000)
+    {
+        throw std::logic_error("ddsketch dense store growth");
+    }
+    //drifting range vs. a simple model: at most maxb consecutive indices,
+    //everything below collapses into the lowest one
+    for(std::size_t maxb : {1, 5, 16, 64}) {
+        auto dd = ddsketch_dense_store<>{maxb};
+        auto ref = std::map<int,std::uint64_t>{};
+        auto idx = std::uniform_int_distribution<int>{-40, 40};
+        for(int j = 0; j < 2000; ++j) {
+            auto i = idx(rnd) + j / 20;
+            dd.add(i);
+            const auto hi = ref.empty() ? i : std::max(i, ref.rbegin()->first);
+            const auto lo = hi - int(maxb) + 1;
+            while(!ref.empty() && ref.begin()->first < lo) {
+                ref[lo] += ref.begin()->second;
+                ref.erase(ref.begin());
+            }
+            ++ref[std::max(i, lo)];
+        }
+        auto bd = std::vector<std::pair<int,std::uint64_t>>{};
+        dd.for_each([&](int i, std::uint64_t c) { bd.emplace_back(i, c); });
+        if(bd != std::vector<std::pair<int,std::uint64_t>>(ref.begin(), ref.end()) ||
+           dd.buckets() > maxb || dd.capacity() > 2 * maxb)
+        {
+            throw std::logic_error("ddsketch dense store collapsing");
+        }
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+int main()
+{
+    try {
+        test_exact_quantiles();
+        test_tdigest();
+        test_kll();
+        test_p2_quantile();
+        test_ddsketch();
+    }
+    catch(std::exception& e) {
+        std::cerr << "wrong " << e.what();
+        return 1;
+    }
+}
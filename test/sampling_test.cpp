@@ -0,0 +1,210 @@
+/*****************************************************************************
+ *
+ * AM utilities
+ *
+ * released under MIT license
+ *
+ * 2008-2016 André Müller
+ *
+ *****************************************************************************/
+
+#include "reservoir.h"
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+
+using namespace am::stat;
+
+
+//-------------------------------------------------------------------
+/// @brief max. relative deviation of inclusion counts from 'expected'
+double max_deviation(const std::vector<int>& counts, double expected)
+{
+    double dev = 0;
+    for(auto c : counts) {
+        dev = std::max(dev, std::abs(c - expected) / expected);
+    }
+    return dev;
+}
+
+
+
+//-------------------------------------------------------------------
+void test_reservoir()
+{
+    const int n = 100;
+    const int k = 10;
+    const int trials = 20000;
+
+    auto values = std::vector<int>(n);
+    std::iota(values.begin(), values.end(), 0);
+
+    //every value is included with probability k/n
+    auto single = std::vector<int>(n, 0);
+    auto bulk   = std::vector<int>(n, 0);
+    auto merged = std::vector<int>(n, 0);
+
+    for(int t = 0; t < trials; ++t) {
+        auto r1 = reservoir_accumulator<int>{k, std::uint64_t(t)};
+        auto r2 = reservoir_accumulator<int>{k, std::uint64_t(t)};
+        for(auto x : values) r1 += x;
+        r2.push(values.begin(), values.end());
+
+        //same seed => bulk push draws the same random numbers
+        if(r1.sample() != r2.sample() || r2.size() != std::uint64_t(n)) {
+            throw std::logic_error("reservoir bulk push");
+        }
+        for(auto x : r1.result()) ++single[x];
+        for(auto x : r2.result()) ++bulk[x];
+
+        //shards of different sizes
+        auto a = reservoir_accumulator<int>{k, std::uint64_t(2*t)};
+        auto b = reservoir_accumulator<int>{k, std::uint64_t(2*t+1)};
+        a.push(values.begin(), values.begin() + 30);
+        b.push(values.begin() + 30, values.end());
+        if(!a.merge(b) || a.size() != std::uint64_t(n) ||
+           a.sample().size() != std::size_t(k))
+        {
+            throw std::logic_error("reservoir merge");
+        }
+        for(auto x : a.result()) ++merged[x];
+    }
+    const auto expected = double(trials) * k / n;
+    if(max_deviation(single, expected) > 0.15 ||
+       max_deviation(merged, expected) > 0.15)
+    {
+        throw std::logic_error("reservoir inclusion probabilities");
+    }
+
+    //skipping over non-random-access ranges
+    auto l = std::list<int>(values.begin(), values.end());
+    auto r1 = reservoir_accumulator<int>{k, 5};
+    auto r2 = reservoir_accumulator<int>{k, 5};
+    r1.push(l.begin(), l.end());
+    r2.push(values.begin(), values.end());
+    if(r1.sample() != r2.sample()) throw std::logic_error("reservoir list push");
+
+    //fewer values than capacity
+    auto s = reservoir_accumulator<int>{k};
+    s.push(values.begin(), values.begin() + 3);
+    auto t = reservoir_accumulator<int>{k};
+    t += 7;
+    s.merge(t);
+    auto res = s.result();
+    std::sort(res.begin(), res.end());
+    if(res != std::vector<int>{0, 1, 2, 7}) {
+        throw std::logic_error("reservoir underfull merge");
+    }
+    if(s.merge(reservoir_accumulator<int>{k+1})) {
+        throw std::logic_error("reservoir merge of different capacities");
+    }
+    s.clear();
+    if(!s.empty() || !s.sample().empty()) throw std::logic_error("reservoir clear");
+}
+
+
+
+//-------------------------------------------------------------------
+void test_weighted_reservoir()
+{
+    const int n = 50;
+    const int trials = 20000;
+
+    //k = 1 => inclusion probability = w / sum(w)
+    auto values = std::vector<int>(n);
+    auto weights = std::vector<double>(n);
+    std::iota(values.begin(), values.end(), 0);
+    for(int i = 0; i < n; ++i) weights[i] = 1 + i % 5;
+    const auto wsum = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    auto counts = std::vector<int>(n, 0);
+    auto mcounts = std::vector<int>(n, 0);
+    for(int t = 0; t < trials; ++t) {
+        auto r = weighted_reservoir_accumulator<int>{1, std::uint64_t(t)};
+        r.push(values.begin(), values.end(), weights.begin());
+        ++counts[r.result().front()];
+
+        auto a = weighted_reservoir_accumulator<int>{1, std::uint64_t(2*t)};
+        auto b = weighted_reservoir_accumulator<int>{1, std::uint64_t(2*t+1)};
+        a.push(values.begin(), values.begin() + 20, weights.begin());
+        b.push(values.begin() + 20, values.end(), weights.begin() + 20);
+        a.merge(b);
+        ++mcounts[a.result().front()];
+    }
+    for(int i = 0; i < n; ++i) {
+        const auto expected = trials * weights[i] / wsum;
+        if(std::abs(counts[i] - expected) > 5 * std::sqrt(expected) + 5 ||
+           std::abs(mcounts[i] - expected) > 5 * std::sqrt(expected) + 5)
+        {
+            throw std::logic_error("weighted reservoir inclusion probabilities");
+        }
+    }
+
+    //a dominant weight is (almost) always sampled; zero weights never
+    auto r = weighted_reservoir_accumulator<int>{5, 1};
+    for(int i = 0; i < 1000; ++i) r.push(i, (i == 500) ? 1e9 : 1.0);
+    r.push(-1, 0.0);
+    const auto s = r.result();
+    if(s.size() != 5 || r.size() != 1000 ||
+       std::find(s.begin(), s.end(), 500) == s.end() ||
+       std::find(s.begin(), s.end(), -1) != s.end())
+    {
+        throw std::logic_error("weighted reservoir");
+    }
+
+    //merge of underfull reservoirs; pushing continues after the merge
+    auto u = weighted_reservoir_accumulator<int>{5, 2};
+    auto v = weighted_reservoir_accumulator<int>{5, 3};
+    u.push(1, 1.0);
+    v.push(2, 1.0);
+    v.push(3, 1.0);
+    if(!u.merge(v) || u.size() != 3 || u.result().size() != 3) {
+        throw std::logic_error("weighted reservoir underfull merge");
+    }
+    for(int i = 10; i < 1000; ++i) u.push(i, (i == 700) ? 1e9 : 1.0);
+    auto us = u.result();
+    if(us.size() != 5 || u.size() != 993 ||
+       std::find(us.begin(), us.end(), 700) == us.end())
+    {
+        throw std::logic_error("weighted reservoir push after underfull merge");
+    }
+
+    //self merge
+    auto sm = weighted_reservoir_accumulator<int>{4, 4};
+    sm.push(1, 1.0);
+    sm.push(2, 1.0);
+    sm.merge(sm);
+    us = sm.result();
+    std::sort(us.begin(), us.end());
+    if(sm.size() != 4 || us != std::vector<int>{1, 1, 2, 2}) {
+        throw std::logic_error("weighted reservoir self merge");
+    }
+    sm.merge(sm);
+    if(sm.size() != 8 || sm.result().size() != 4) {
+        throw std::logic_error("weighted reservoir self merge (full)");
+    }
+
+    r.clear();
+    if(!r.empty() || !r.result().empty()) throw std::logic_error("weighted reservoir clear");
+}
+
+
+
+//-------------------------------------------------------------------
+int main()
+{
+    try {
+        test_reservoir();
+        test_weighted_reservoir();
+    }
+    catch(std::exception& e) {
+        std::cerr << "wrong " << e.what();
+        return 1;
+    }
+}
@@ -0,0 +1,300 @@
+/*****************************************************************************
+ *
+ * AM utilities
+ *
+ * released under MIT license
+ *
+ * 2008-2016 André Müller
+ *
+ *****************************************************************************/
+
+#include "hyperloglog.h"
+#include "space_saving.h"
+#include "count_min.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+
+using namespace am::stat;
+
+
+//-------------------------------------------------------------------
+void test_hyperloglog()
+{
+    using std::abs;
+
+    auto h = hyperloglog_accumulator<std::uint64_t>{12};
+
+    //small cardinalities: sparse & (almost) exact
+    for(std::uint64_t i = 0; i < 100; ++i) {
+        h += i;
+        h += i;
+    }
+    if(!h.is_sparse() || abs(h.estimate() - 100) > 1) {
+        throw std::logic_error("hyperloglog sparse estimate");
+    }
+
+    //large cardinalities: dense, within a few standard errors
+    for(std::uint64_t i = 0; i < 200000; ++i) h += i;
+    if(h.is_sparse() || abs(h.estimate() / 200000 - 1) > 4 * h.relative_error()) {
+        throw std::logic_error("hyperloglog dense estimate");
+    }
+
+    //shards: 4 x sparse + 4 x dense, with overlap
+    auto all = hyperloglog_accumulator<std::string>{12};
+    auto shards = std::vector<hyperloglog_accumulator<std::string>>(
+        8, hyperloglog_accumulator<std::string>{12});
+    for(int i = 0; i < 100000; ++i) {
+        const auto id = "client" + std::to_string(i);
+        const auto s = (i < 200) ? std::size_t(i % 4) : std::size_t(4 + i % 4);
+        shards[s] += id;
+        shards[(s + 1) % 8] += id;
+    }
+    for(int i = 0; i < 100000; ++i) all += "client" + std::to_string(i);
+
+    auto merged = hyperloglog_accumulator<std::string>{12};
+    for(const auto& s : shards) {
+        if(!merged.merge(s)) throw std::logic_error("hyperloglog merge");
+    }
+    if(abs(merged.estimate() - all.estimate()) > 1e-9 * all.estimate()) {
+        throw std::logic_error("hyperloglog merge estimate");
+    }
+    if(merged.merge(hyperloglog_accumulator<std::string>{10})) {
+        throw std::logic_error("hyperloglog merge of different precisions");
+    }
+
+    //sparse + sparse
+    auto a = hyperloglog_accumulator<int>{};
+    auto b = hyperloglog_accumulator<int>{};
+    const auto v = std::vector<int>{1, 2, 3, 4, 5, 6};
+    a.push(v.begin(), v.begin() + 4);
+    b.push(v.begin() + 2, v.end());
+    a.merge(b);
+    if(!a.is_sparse() || abs(a.result() - 6) > 0.01) {
+        throw std::logic_error("hyperloglog sparse merge");
+    }
+
+    //const estimate on a non-empty insert buffer == estimate after compaction
+    auto u = hyperloglog_accumulator<int>{12};
+    for(int i = 0; i < 10; ++i) { u += i; u += i; }
+    const auto cu = u;
+    const auto e1 = cu.estimate();
+    u.merge(hyperloglog_accumulator<int>{12});
+    if(e1 != cu.estimate() || e1 != u.estimate() || abs(e1 - 10) > 0.01) {
+        throw std::logic_error("hyperloglog const estimate");
+    }
+
+    a.clear();
+    if(a.estimate() != 0) throw std::logic_error("hyperloglog clear");
+}
+
+
+//-------------------------------------------------------------------
+void test_space_saving()
+{
+    //Zipf-like stream over 10000 keys
+    auto urng = std::mt19937_64{42};
+    auto keys = std::vector<int>{};
+    {
+        auto w = std::vector<double>{};
+        for(int i = 1; i <= 10000; ++i) w.push_back(1.0 / i);
+        auto distr = std::discrete_distribution<int>(w.begin(), w.end());
+        for(int i = 0; i < 200000; ++i) keys.push_back(distr(urng));
+    }
+    auto exact = std::unordered_map<int,std::uint64_t>{};
+    for(auto k : keys) ++exact[k];
+
+    auto check_bounds = [&](const space_saving_accumulator<int>& s) {
+        for(const auto& e : s.result()) {
+            const auto t = exact[e.key];
+            if(e.count < t || e.count - e.error > t) {
+                throw std::logic_error("space_saving error bounds");
+            }
+        }
+        if(s.min_count() > s.total() / s.capacity()) {
+            throw std::logic_error("space_saving min count bound");
+        }
+        //all keys with frequency > 1/capacity must be monitored
+        for(const auto& kv : exact) {
+            if(kv.second > s.total() / s.capacity() && !s.monitored(kv.first)) {
+                throw std::logic_error("space_saving heavy hitter missing");
+            }
+        }
+    };
+
+    auto s = space_saving_accumulator<int>{100};
+    for(auto k : keys) s += k;
+    if(s.size() != 100 || s.total() != keys.size()) {
+        throw std::logic_error("space_saving size");
+    }
+    check_bounds(s);
+
+    auto top = s.top(3);
+    if(top.size() != 3 || top[0].key != 0 || top[1].key != 1 || top[2].key != 2 ||
+       top[0].count < top[1].count || top[1].count < top[2].count)
+    {
+        throw std::logic_error("space_saving top");
+    }
+    for(const auto& e : s.heavy_hitters(0.02, true)) {
+        if(double(exact[e.key]) <= 0.02 * keys.size()) {
+            throw std::logic_error("space_saving guaranteed heavy hitters");
+        }
+    }
+
+    //bulk push (with runs of equal keys) yields the same summary
+    auto sorted = keys;
+    std::sort(sorted.begin(), sorted.begin() + 1000);
+    auto s1 = space_saving_accumulator<int>{100};
+    auto s2 = space_saving_accumulator<int>{100};
+    for(auto k : sorted) s1 += k;
+    s2.push(sorted.begin(), sorted.end());
+    for(const auto& e : s1.result()) {
+        if(s2.estimate(e.key) != e.count || s2.error(e.key) != e.error) {
+            throw std::logic_error("space_saving bulk push");
+        }
+    }
+
+    //merge of two shards
+    auto a = space_saving_accumulator<int>{100};
+    auto b = space_saving_accumulator<int>{100};
+    a.push(keys.begin(), keys.begin() + 120000);
+    b.push(keys.begin() + 120000, keys.end());
+    a.merge(b);
+    if(a.size() != 100 || a.total() != keys.size()) {
+        throw std::logic_error("space_saving merge size");
+    }
+    check_bounds(a);
+    if(a.top(1).front().key != 0) throw std::logic_error("space_saving merge top");
+
+    //not yet full => exact
+    auto c = space_saving_accumulator<std::string>{10};
+    for(auto x : {"a", "b", "a", "c", "a", "b"}) c += x;
+    if(c.estimate("a") != 3 || c.guaranteed("b") != 2 || c.estimate("d") != 0 ||
+       c.top(1).front().key != "a")
+    {
+        throw std::logic_error("space_saving exact counts");
+    }
+    c.clear();
+    if(!c.empty() || c.total() != 0) throw std::logic_error("space_saving clear");
+}
+
+
+//-------------------------------------------------------------------
+void test_count_min()
+{
+    auto urng = std::mt19937_64{7};
+    auto keys = std::vector<std::uint64_t>{};
+    {
+        auto w = std::vector<double>{};
+        for(int i = 1; i <= 50000; ++i) w.push_back(1.0 / i);
+        auto distr = std::discrete_distribution<std::uint64_t>(w.begin(), w.end());
+        for(int i = 0; i < 300000; ++i) keys.push_back(distr(urng));
+    }
+    auto exact = std::unordered_map<std::uint64_t,std::uint32_t>{};
+    for(auto k : keys) ++exact[k];
+
+    auto plain = count_min_accumulator<std::uint64_t>{2000, 5};
+    auto cons  = count_min_accumulator<std::uint64_t>{2000, 5, true};
+    if(plain.width() != 2048 || plain.depth() != 5) {
+        throw std::logic_error("count_min dimensions");
+    }
+    for(auto k : keys) plain += k;
+    cons.push(keys.begin(), keys.end());
+    if(plain.total() != keys.size() || cons.total() != keys.size()) {
+        throw std::logic_error("count_min total");
+    }
+
+    //never undercounts; overcount bound holds for (almost) all keys
+    const auto bound = plain.relative_error() * double(keys.size());
+    std::size_t violations = 0;
+    std::uint64_t errPlain = 0, errCons = 0;
+    for(const auto& kv : exact) {
+        const auto p = plain.estimate(kv.first);
+        const auto c = cons[kv.first];
+        if(p < kv.second || c < kv.second || c > p) {
+            throw std::logic_error("count_min undercount");
+        }
+        if(double(p - kv.second) > bound) ++violations;
+        errPlain += p - kv.second;
+        errCons  += c - kv.second;
+    }
+    if(double(violations) > 2 * plain.failure_probability() * double(exact.size()) ||
+       errCons >= errPlain)
+    {
+        throw std::logic_error("count_min error bound");
+    }
+
+    //bulk push == single pushes
+    auto bulk = count_min_accumulator<std::uint64_t>{2000, 5};
+    bulk.push(keys.begin(), keys.end());
+    for(const auto& kv : exact) {
+        if(bulk.estimate(kv.first) != plain.estimate(kv.first)) {
+            throw std::logic_error("count_min bulk push");
+        }
+    }
+
+    //merge of shards == single sketch
+    auto a = count_min_accumulator<std::uint64_t>{2000, 5};
+    auto b = count_min_accumulator<std::uint64_t>{2000, 5};
+    a.push(keys.begin(), keys.begin() + 100000);
+    b.push(keys.begin() + 100000, keys.end());
+    if(!a.merge(b) || a.total() != plain.total()) {
+        throw std::logic_error("count_min merge");
+    }
+    for(const auto& kv : exact) {
+        if(a.estimate(kv.first) != plain.estimate(kv.first)) {
+            throw std::logic_error("count_min merge estimates");
+        }
+    }
+    if(a.merge(count_min_accumulator<std::uint64_t>{1024, 5})) {
+        throw std::logic_error("count_min merge of different dimensions");
+    }
+
+    auto s = count_min_accumulator<std::string,std::uint16_t>{64, 3};
+    s.push("x", 5);
+    s += "y";
+    if(s.estimate("x") < 5 || s.result() != 6) {
+        throw std::logic_error("count_min weighted push");
+    }
+
+    //16-bit counters saturate instead of wrapping around
+    for(bool conservative : {false, true}) {
+        auto c = count_min_accumulator<int,std::uint16_t>{64, 3, conservative};
+        c.push(1, 65535);
+        c.push(1, 1);
+        if(c.estimate(1) != 65535 || c.total() != 65536) {
+            throw std::logic_error("count_min saturation");
+        }
+        auto d = count_min_accumulator<int,std::uint16_t>{64, 3, conservative};
+        d.push(1, 100);
+        d.merge(c);
+        if(d.estimate(1) != 65535) throw std::logic_error("count_min merge saturation");
+    }
+
+    s.clear();
+    if(s.estimate("x") != 0 || s.total() != 0) throw std::logic_error("count_min clear");
+}
+
+
+
+//-------------------------------------------------------------------
+int main()
+{
+    try {
+        test_hyperloglog();
+        test_space_saving();
+        test_count_min();
+    }
+    catch(std::exception& e) {
+        std::cerr << "wrong " << e.what();
+        return 1;
+    }
+}
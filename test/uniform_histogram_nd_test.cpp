@@ -0,0 +1,136 @@
+/*****************************************************************************
+ *
+ * AM utilities
+ *
+ * released under MIT license
+ *
+ * 2008-2016 André Müller
+ *
+ *****************************************************************************/
+
+#include "uniform_histogram_nd.h"
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <stdexcept>
+
+
+using namespace am::stat;
+
+
+//-------------------------------------------------------------------
+void test_2d()
+{
+    auto h = uniform_histogram_2d<double>{{0.0, 0.0}, {4.0, 3.0}, {1.0, 1.0}};
+
+    if(h.size() != 12 || h.shape()[0] != 4 || h.shape()[1] != 3) {
+        throw std::logic_error("uniform_histogram_2d shape");
+    }
+
+    auto xs = std::vector<double>{0.5, 0.5, 1.5, 3.9, 2.0, 5.0, -1.0, 0.1};
+    auto ys = std::vector<double>{0.5, 2.5, 1.5, 2.9, 0.0, 1.0,  1.0, 0.2};
+
+    auto g = h;
+
+    //single point insert
+    for(std::size_t i = 0; i < xs.size(); ++i) {
+        h.insert({xs[i], ys[i]});
+    }
+    //structure of arrays batch insert
+    g.insert(std::array<const double*,2>{xs.data(), ys.data()}, xs.size());
+
+    if(!std::equal(h.begin(), h.end(), g.begin())) {
+        throw std::logic_error("uniform_histogram_2d batch insert");
+    }
+
+    if( !( (h.total() == 6)
+        && (h({0.7, 0.7}) == 2)
+        && (h[{0,2}] == 1)
+        && (h[{1,1}] == 1)
+        && (h[{2,0}] == 1)
+        && (h[{3,2}] == 1) ))
+    {
+        throw std::logic_error("uniform_histogram_2d result");
+    }
+
+    auto mx = std::array<std::uint_least32_t,4>{};
+    auto my = std::array<std::uint_least32_t,3>{};
+    h.marginal(0, mx.begin());
+    h.marginal(1, my.begin());
+
+    if( !( (mx == std::array<std::uint_least32_t,4>{{3,1,1,1}})
+        && (my == std::array<std::uint_least32_t,3>{{3,1,2}}) ))
+    {
+        throw std::logic_error("uniform_histogram_2d marginals");
+    }
+
+    for(std::size_t i = 0; i < mx.size(); ++i) {
+        if(h.marginal_count(0,i) != mx[i]) {
+            throw std::logic_error("uniform_histogram_2d marginal lookup");
+        }
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_3d()
+{
+    auto h = uniform_histogram_3d<int>{{0,0,0}, {10,4,2}, {5,1,1}};
+
+    if(h.size() != 16) {
+        throw std::logic_error("uniform_histogram_3d shape");
+    }
+
+    h.insert({7,3,1});
+    h.insert({7,3,1});
+    h.insert({1,0,0});
+
+    auto mz = std::array<std::uint_least32_t,2>{};
+    h.marginal(2, mz.begin());
+
+    if( !( (h[{1,3,1}] == 2)
+        && (h.index({1,0,0}) == 0)
+        && (h.flat_index({1,3,1}) == h.index({7,3,1}))
+        && (mz[0] == 1 && mz[1] == 2)
+        && (h.marginal_count(1,3) == 2) ))
+    {
+        throw std::logic_error("uniform_histogram_3d result");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_empty_axis()
+{
+    //zero width along axis 1 => no bins at all
+    const auto h = uniform_histogram_nd<double,2>{{0,0}, {5,1}, {1,0}};
+
+    auto mx = std::array<double,5>{};
+    h.marginal(0, mx.begin());
+
+    if( !( h.empty()
+        && (h.marginal_count(0,2) == 0)
+        && (mx[2] == 0) ))
+    {
+        throw std::logic_error("uniform_histogram_nd with empty axis");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+int main()
+{
+    try {
+        test_2d();
+        test_3d();
+        test_empty_axis();
+    }
+    catch(std::exception& e) {
+        std::cerr << "wrong " << e.what();
+        return 1;
+    }
+}
@@ -9,8 +9,12 @@
  *****************************************************************************/
 
 #include "uniform_histogram.h"
+#include "rebin.h"
+#include "decaying_histogram.h"
 
 #include <iostream>
+#include <algorithm>
+#include <iterator>
 #include <random>
 #include <functional>
 
@@ -25,9 +29,6 @@ void fp_accumulation()
     static_assert(std::is_floating_point<T>::value,
         "test expects builtin floating point type");
 
-    using std::abs;
-    constexpr auto eps = 0.1;
-
     auto uh = uniform_histogram<T>{0, 20, 0.5};
 
     auto v = std::vector<T>{
@@ -38,48 +39,48 @@ void fp_accumulation()
         uh.insert(static_cast<T>(y));
     }
    
-    if( !( (abs(uh.total() - 21) < eps)
-        && (abs(uh.size() - 40) < eps)
-        && (abs(uh[ 0] - 2) < eps)
-        && (abs(uh[ 1] - 0) < eps)
-        && (abs(uh[ 2] - 3) < eps)
-        && (abs(uh[ 3] - 0) < eps)
-        && (abs(uh[ 4] - 1) < eps)
-        && (abs(uh[ 5] - 1) < eps)
-        && (abs(uh[ 6] - 2) < eps)
-        && (abs(uh[ 7] - 0) < eps)
-        && (abs(uh[ 8] - 1) < eps)
-        && (abs(uh[ 9] - 0) < eps)
-        && (abs(uh[10] - 2) < eps)
-        && (abs(uh[11] - 0) < eps)
-        && (abs(uh[12] - 0) < eps)
-        && (abs(uh[13] - 1) < eps)
-        && (abs(uh[14] - 0) < eps)
-        && (abs(uh[15] - 0) < eps)
-        && (abs(uh[16] - 0) < eps)
-        && (abs(uh[17] - 1) < eps)
-        && (abs(uh[18] - 0) < eps)
-        && (abs(uh[19] - 0) < eps)
-        && (abs(uh[20] - 1) < eps)
-        && (abs(uh[21] - 0) < eps)
-        && (abs(uh[22] - 1) < eps)
-        && (abs(uh[23] - 0) < eps)
-        && (abs(uh[24] - 0) < eps)
-        && (abs(uh[25] - 0) < eps)
-        && (abs(uh[26] - 1) < eps)
-        && (abs(uh[27] - 0) < eps)
-        && (abs(uh[28] - 1) < eps)
-        && (abs(uh[29] - 0) < eps)
-        && (abs(uh[30] - 1) < eps)
-        && (abs(uh[31] - 0) < eps)
-        && (abs(uh[32] - 0) < eps)
-        && (abs(uh[33] - 0) < eps)
-        && (abs(uh[34] - 0) < eps)
-        && (abs(uh[35] - 0) < eps)
-        && (abs(uh[36] - 1) < eps)
-        && (abs(uh[37] - 0) < eps)
-        && (abs(uh[38] - 0) < eps)
-        && (abs(uh[39] - 1) < eps) ))
+    if( !( (uh.total() == 21)
+        && (uh.size() == 40)
+        && (uh[ 0] == 2)
+        && (uh[ 1] == 0)
+        && (uh[ 2] == 3)
+        && (uh[ 3] == 0)
+        && (uh[ 4] == 1)
+        && (uh[ 5] == 1)
+        && (uh[ 6] == 2)
+        && (uh[ 7] == 0)
+        && (uh[ 8] == 1)
+        && (uh[ 9] == 0)
+        && (uh[10] == 2)
+        && (uh[11] == 0)
+        && (uh[12] == 0)
+        && (uh[13] == 1)
+        && (uh[14] == 0)
+        && (uh[15] == 0)
+        && (uh[16] == 0)
+        && (uh[17] == 1)
+        && (uh[18] == 0)
+        && (uh[19] == 0)
+        && (uh[20] == 1)
+        && (uh[21] == 0)
+        && (uh[22] == 1)
+        && (uh[23] == 0)
+        && (uh[24] == 0)
+        && (uh[25] == 0)
+        && (uh[26] == 1)
+        && (uh[27] == 0)
+        && (uh[28] == 1)
+        && (uh[29] == 0)
+        && (uh[30] == 1)
+        && (uh[31] == 0)
+        && (uh[32] == 0)
+        && (uh[33] == 0)
+        && (uh[34] == 0)
+        && (uh[35] == 0)
+        && (uh[36] == 1)
+        && (uh[37] == 0)
+        && (uh[38] == 0)
+        && (uh[39] == 1) ))
     {
         throw std::logic_error("uniform_histogram result");
     }
@@ -87,6 +88,214 @@ void fp_accumulation()
 
 
 
+//-------------------------------------------------------------------
+template<class T>
+void weighted_accumulation()
+{
+    using std::abs;
+    constexpr auto eps = 0.001;
+
+    auto v = std::vector<T>{1, 2, T(2.5), 3, 25, T(4.5)};
+    auto w = std::vector<double>{0.5, 2, T(1.25), 10, 7, 0.125};
+
+    //fractional counts
+    auto fh = uniform_histogram<T,std::vector<double>>{0, 5, 1};
+    fh.insert(v.begin(), v.end(), w.begin());
+    fh.insert(T(4.1), 0.25);
+
+    if( !( (abs(fh.total() - 14.125) < eps)
+        && (abs(fh[0] - 0.0)   < eps)
+        && (abs(fh[1] - 0.5)   < eps)
+        && (abs(fh[2] - 3.25)  < eps)
+        && (abs(fh[3] - 10.0)  < eps)
+        && (abs(fh[4] - 0.375) < eps) ))
+    {
+        throw std::logic_error("uniform_histogram weighted result");
+    }
+
+    //integral counts
+    auto n = std::vector<std::uint_least32_t>{1, 2, 3, 4, 5, 6};
+    auto ih = uniform_histogram<T>{0, 5, 1};
+    ih.insert(v.begin(), v.end(), n.begin());
+    ih.insert(0, 1000);
+
+    if( !( (ih.total() == 1016)
+        && (ih[0] == 1000)
+        && (ih[1] == 1)
+        && (ih[2] == 5)
+        && (ih[3] == 4)
+        && (ih[4] == 6) ))
+    {
+        throw std::logic_error("uniform_histogram counted result");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void rebinning()
+{
+    using std::abs;
+    constexpr auto eps = 0.001;
+
+    auto src = uniform_histogram<double>{0, 10, 1};
+    for(int i = 0; i < 10; ++i) {
+        src.insert(i + 0.5, i + 1);
+    }
+
+    //merge k adjacent bins
+    auto m = uniform_histogram<double>{};
+    merge_bins(src, 3, m);
+
+    if( !( (m.size() == 4)
+        && (abs(m.bin_width() - 3) < eps)
+        && (abs(m.max() - 12) < eps)
+        && (m[0] == 6) && (m[1] == 15) && (m[2] == 24) && (m[3] == 10)
+        && (m.total() == src.total()) ))
+    {
+        throw std::logic_error("uniform_histogram merge_bins");
+    }
+
+    //change width: proportional split for fractional counts
+    auto f = uniform_histogram<double,std::vector<double>>{};
+    rebin(src, 2.5, f);
+
+    if( !( (f.size() == 4)
+        && (abs(f[0] - 4.5)  < eps)
+        && (abs(f[1] - 10.5) < eps)
+        && (abs(f[2] - 17.0) < eps)
+        && (abs(f[3] - 23.0) < eps) ))
+    {
+        throw std::logic_error("uniform_histogram rebin (fractional)");
+    }
+
+    //change width: integral counts go to the bin containing the center
+    auto c = uniform_histogram<double>{};
+    rebin(src, 4.0, c);
+
+    if( !( (c.size() == 3)
+        && (c[0] == 10) && (c[1] == 26) && (c[2] == 19) ))
+    {
+        throw std::logic_error("uniform_histogram rebin (integral)");
+    }
+
+    //projection onto non-uniform bins
+    auto nu = nonuniform_histogram<double>{0.0, 1.0, 2.0, 4.0, 8.0, 20.0};
+    project(src, nu);
+
+    if( !( (nu[0].second == 1) && (nu[1].second == 2)
+        && (nu[2].second == 7) && (nu[3].second == 26)
+        && (nu[4].second == 19) && (nu[5].second == 0) ))
+    {
+        throw std::logic_error("uniform_histogram project (nonuniform)");
+    }
+
+    auto nf = nonuniform_histogram<double,double>{-5.0, 0.5, 5.0};
+    project(src, nf);
+
+    if( !( (abs(nf[0].second - 0.5) < eps)
+        && (abs(nf[1].second - 14.5) < eps)
+        && (abs(nf[2].second - 0.0) < eps) ))
+    {
+        throw std::logic_error("uniform_histogram project (fractional)");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void frequencies()
+{
+    using std::abs;
+    constexpr auto eps = 0.0001;
+
+    auto h = uniform_histogram<double>{0, 4, 1};
+    h.insert(0.5, 1);
+    h.insert(1.5, 3);
+    h.insert(3.5, 4);
+
+    const auto expected = std::vector<double>{0.125, 0.375, 0.0, 0.5};
+
+    auto out = std::vector<double>(h.size());
+    relative_frequencies(h, out.begin());
+
+    const auto res = relative_frequencies(h);
+    const auto view = normalized(h);
+
+    if(view.size() != expected.size() || res.size() != expected.size()) {
+        throw std::logic_error("uniform_histogram relative_frequencies size");
+    }
+
+    auto it = view.begin();
+    for(std::size_t i = 0; i < expected.size(); ++i, ++it) {
+        if( !( (abs(out[i] - expected[i]) < eps)
+            && (abs(res[i] - expected[i]) < eps)
+            && (abs(view[i] - expected[i]) < eps)
+            && (abs(*it - expected[i]) < eps) ))
+        {
+            throw std::logic_error("uniform_histogram relative_frequencies");
+        }
+    }
+    if(it != view.end()) {
+        throw std::logic_error("uniform_histogram normalized view iteration");
+    }
+
+    //random access iterator requirements
+    const auto first = view.begin();
+    const auto last = view.end();
+    if( !( (std::distance(first, last) == 4)
+        && (first < last) && (last > first) && (first <= first) && (last >= first)
+        && (abs(*(2 + first) - 0.0) < eps)
+        && (abs(*(first + 1).operator->() - 0.375) < eps)
+        && (abs(*std::max_element(first, last) - 0.5) < eps)
+        && (std::lower_bound(first + 2, last, 0.25) == first + 3) ))
+    {
+        throw std::logic_error("uniform_histogram normalized view iterator");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void decay()
+{
+    using std::abs;
+    using std::log;
+    constexpr auto eps = 0.0001;
+
+    //half life of 10 time units
+    auto h = decaying_uniform_histogram<double>{
+        uniform_histogram<double,std::vector<double>>{0, 4, 1}, log(2.0) / 10};
+
+    h.insert(0.5);
+    h.insert(0.5);
+    h.advance(10);
+    h.insert(2.5);
+    h.advance(20);
+
+    if( !( (abs(h(0.5) - 0.5) < eps)
+        && (abs(h(2.5) - 0.5) < eps)
+        && (abs(h.total() - 1.0) < eps) ))
+    {
+        throw std::logic_error("decaying_histogram result");
+    }
+
+    //far in the future: forces renormalization of the stored counts
+    h.insert(3.5, 4.0);
+    h.advance(1020);
+    h.insert(1.5);
+
+    if( !( (h.landmark() > 0)
+        && (abs(h(1.5) - 1.0) < eps)
+        && (h(3.5) < eps)
+        && (abs(h.total() - 1.0) < eps) ))
+    {
+        throw std::logic_error("decaying_histogram renormalization");
+    }
+}
+
+
+
 //-------------------------------------------------------------------
 int main()
 {
@@ -94,6 +303,11 @@ int main()
         fp_accumulation<float>();
         fp_accumulation<double>();
         fp_accumulation<long double>();
+        weighted_accumulation<float>();
+        weighted_accumulation<double>();
+        rebinning();
+        frequencies();
+        decay();
     }
     catch(std::exception& e) {
         std::cerr << "wrong " << e.what();
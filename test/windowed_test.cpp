@@ -0,0 +1,563 @@
+/*****************************************************************************
+ *
+ * AM utilities
+ *
+ * released under MIT license
+ *
+ * 2008-2016 André Müller
+ *
+ *****************************************************************************/
+
+#include "windowed_histogram.h"
+#include "windowed.h"
+#include "ring_buffer.h"
+#include "window_buffer.h"
+#include "total.h"
+#include "moments.h"
+#include "windowed_min_max.h"
+#include "merging_windowed.h"
+#include "time_windowed.h"
+#include "hopping_windowed.h"
+#include "multi_windowed.h"
+#include "windowed_quantile.h"
+#include "max.h"
+#include "initial.h"
+#include "current.h"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <chrono>
+
+
+using namespace am::stat;
+
+
+//-------------------------------------------------------------------
+void test_windowed_histogram()
+{
+    auto h = windowed_histogram<uniform_histogram<double>>{
+        uniform_histogram<double>{0, 10, 1}, 4};
+
+    for(double x : {0.5, 1.5, 1.5, 2.5, 20.0, 3.5}) {
+        h += x;
+    }
+    //window: 1.5, 2.5, 20 (out of range), 3.5
+
+    const auto& r = h.result();
+    if( !( (h.size() == 4)
+        && (r.total() == 3)
+        && (r[0] == 0) && (r[1] == 1) && (r[2] == 1) && (r[3] == 1) ))
+    {
+        throw std::logic_error("windowed_histogram result");
+    }
+
+    auto n = windowed_histogram<nonuniform_histogram<double>>{
+        nonuniform_histogram<double>{0.0, 1.0, 10.0, 100.0}, 2};
+
+    const auto v = std::vector<double>{5.0, 50.0, 0.5};
+    n.push(v.begin(), v.end());
+
+    if( !( (n.result().total() == 2)
+        && (n.result()(50.0) == 1)
+        && (n.result()(0.1) == 1)
+        && (n.result()(5.0) == 0) ))
+    {
+        throw std::logic_error("windowed_histogram (nonuniform) result");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_interval_windowed_histogram()
+{
+    using std::abs;
+
+    //3 intervals of 10 time units each
+    auto h = interval_windowed_histogram<uniform_histogram<double>>{
+        uniform_histogram<double>{0, 100, 1}, 10, 3};
+
+    for(int i = 0; i < 100; ++i) h += i + 0.5;
+    h.advance(10);
+    h += 99.5;
+    h.advance(25);
+    h += 99.5;
+
+    if( !( (h.result().total() == 102)
+        && (h.result()[99] == 3)
+        && (abs(quantile(h.result(), 0.5) - 51.0) < 0.01) ))
+    {
+        throw std::logic_error("interval_windowed_histogram result");
+    }
+
+    //first interval expires
+    h.advance(30);
+    if( !( (h.result().total() == 2)
+        && (abs(quantile(h.result(), 0.99) - 99.99) < 0.01) ))
+    {
+        throw std::logic_error("interval_windowed_histogram expiry");
+    }
+
+    //everything expires
+    h.advance(1000);
+    if(h.result().total() != 0) {
+        throw std::logic_error("interval_windowed_histogram full expiry");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_ring_buffer()
+{
+    auto b = am::ring_buffer<int>{5};
+    if(b.capacity() != 8) throw std::logic_error("ring_buffer capacity");
+
+    for(int i = 0; i < 6; ++i) b.push_back(i);
+    b.pop_front(4);
+    const auto v = std::vector<int>{6, 7, 8, 9};
+    b.push_back(v.begin(), v.end());
+    //stored: 4 5 6 7 8 9, wraps around
+
+    const auto s1 = b.first_span();
+    const auto s2 = b.second_span();
+
+    if( !( (b.size() == 6) && (b.capacity() == 8)
+        && (b.front() == 4) && (b.back() == 9) && (b[2] == 6)
+        && (s1.size() == 4) && (s2.size() == 2)
+        && (*s1.begin() == 4) && (*s2.begin() == 8)
+        && (std::accumulate(b.begin(), b.end(), 0) == 39) ))
+    {
+        throw std::logic_error("ring_buffer result");
+    }
+
+    b.clear();
+    b.push_back(v.begin(), v.end());
+    b.push_back(v.begin(), v.end());
+    b.push_back(1);
+    if( !( (b.size() == 9) && (b.capacity() == 16)
+        && (b[4] == 6) && (b.back() == 1) ))
+    {
+        throw std::logic_error("ring_buffer growth");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_window_buffer()
+{
+    auto b = am::window_buffer<int,4>{1, 2, 3};
+    b.push_back(4);
+    b.push_back(5);
+    //window: 2 3 4 5
+
+    if( !( b.full() && (b.size() == 4)
+        && (b.front() == 2) && (b.back() == 5) && (b[1] == 3)
+        && (b.first_span().size() == 3) && (b.second_span().size() == 1)
+        && (*b.first_span().begin() == 2) && (*b.second_span().begin() == 5)
+        && (std::accumulate(b.begin(), b.end(), 0) == 14) ))
+    {
+        throw std::logic_error("window_buffer result");
+    }
+
+    const auto v = std::vector<int>{6, 7, 8, 9, 10, 11};
+    b.push_back(v.begin(), v.end());
+    b.pop_front();
+    if( !( (b.size() == 3) && (b.front() == 9) && (b.back() == 11) ))
+    {
+        throw std::logic_error("window_buffer bulk push");
+    }
+
+    auto w = fixed_windowed<sum_accumulator<int>,3>{};
+    w.push(v.begin(), v.end());
+    if(w.result().result() != 30 || w.top() != 11 || w.values()[0] != 9) {
+        throw std::logic_error("fixed_windowed result");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_windowed()
+{
+    using std::abs;
+
+    auto w = windowed<sum_accumulator<int>>{};
+    w.resize_window(3);
+    for(int i = 1; i <= 5; ++i) w += i;
+
+    if(w.result().result() != 12 || w.size() != 3 || w.top() != 5) {
+        throw std::logic_error("windowed result");
+    }
+
+    w.resize_window(2);
+    if(w.result().result() != 9) {
+        throw std::logic_error("windowed resize");
+    }
+
+    const auto v = std::vector<int>{10, 20, 30, 40};
+    w.push(v.begin(), v.begin() + 1);
+    if(w.result().result() != 15) {
+        throw std::logic_error("windowed bulk push");
+    }
+    w.push(v.begin(), v.end());
+    if(w.result().result() != 70 || w.size() != 2) {
+        throw std::logic_error("windowed bulk push (overflow)");
+    }
+
+    w.clear();
+    if(w.result().result() != 0 || !w.empty()) {
+        throw std::logic_error("windowed clear");
+    }
+
+    auto m = windowed<moments_accumulator<double,2>>{};
+    m.resize_window(4);
+    for(double x : {100.0, 100.0, 1.0, 2.0, 3.0, 4.0}) m += x;
+
+    if(abs(m.result().mean() - 2.5) > 0.0001) {
+        throw std::logic_error("windowed moments result");
+    }
+
+    //periodic recompute: on by default for floating-point samples only
+    if(w.recompute_interval() != 0 || m.recompute_interval() != 4) {
+        throw std::logic_error("windowed default recompute interval");
+    }
+    m.resize_window(8);
+    m.recompute_every(3);
+    if(m.recompute_interval() != 3) {
+        throw std::logic_error("windowed recompute interval");
+    }
+    m.recompute_every(windowed<moments_accumulator<double,2>>::per_window);
+    if(m.recompute_interval() != 8) {
+        throw std::logic_error("windowed recompute interval (per window)");
+    }
+
+    //large offset + long run: add/subtract drift is bounded by the
+    //default periodic recompute
+    auto urd = std::uniform_real_distribution<double>{0, 1};
+    auto rng = std::mt19937{42};
+    auto d = windowed<moments_accumulator<double,2>>{};
+    d.resize_window(64);
+    auto vals = std::vector<double>{};
+    for(int i = 0; i < 1000000; ++i) {
+        const double x = 1e4 + urd(rng);
+        d += x;
+        vals.push_back(x);
+    }
+    auto ref = moments_accumulator<double,2>{};
+    for(auto i = vals.size() - 64; i < vals.size(); ++i) ref += vals[i] - 1e4;
+
+    if(abs(d.result().variance() - ref.variance()) > 1e-6 ||
+       abs(d.result().mean() - 1e4 - ref.mean()) > 1e-6)
+    {
+        throw std::logic_error("windowed moments recompute");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_time_windowed()
+{
+    auto w = time_windowed<sum_accumulator<int>>{10.0};
+    w.push(0.0, 1);
+    w.push(5.0, 2);
+    w.push(9.0, 4);
+    w.push(10.0, 8);    //sample at 0 expires
+    if(w.result().result() != 14 || w.size() != 3 || w.oldest() != 5.0) {
+        throw std::logic_error("time_windowed push");
+    }
+
+    //batch eviction
+    if(w.advance(19.5) != 2 || w.result().result() != 8) {
+        throw std::logic_error("time_windowed advance");
+    }
+    //earlier time is ignored
+    if(w.advance(3.0) != 0 || w.size() != 1) {
+        throw std::logic_error("time_windowed advance (past)");
+    }
+    //late samples are dropped; the buffer stays sorted
+    if(w.push(15.0, 32) || w.size() != 1 || w.result().result() != 8) {
+        throw std::logic_error("time_windowed push (out of order)");
+    }
+    if(!w.push(19.8, 64) || w.size() != 2 || w.result().result() != 72 ||
+       w.advance(19.9) != 0 || w.advance(20.5) != 1 || w.result().result() != 64)
+    {
+        throw std::logic_error("time_windowed eviction after out of order push");
+    }
+    w.advance(100.0);
+    if(!w.empty() || w.result().result() != 0) {
+        throw std::logic_error("time_windowed expiry");
+    }
+    //time never moves backwards, not even in an empty window
+    if(w.advance(50.0) != 0 || w.now() != 100.0) {
+        throw std::logic_error("time_windowed advance (past, empty)");
+    }
+    //clear restarts the clock
+    w.clear();
+    w.push(-5.0, 16);
+    if(w.now() != -5.0 || w.size() != 1 || w.result().result() != 16) {
+        throw std::logic_error("time_windowed clear");
+    }
+
+    using clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    const auto t0 = clock::time_point{};
+    auto c = time_windowed<moments_accumulator<double,1>,
+                           clock::time_point,clock::duration>{milliseconds(100)};
+
+    const auto ts = std::vector<clock::time_point>{
+        t0, t0 + milliseconds(50), t0 + milliseconds(120), t0 + milliseconds(130)};
+    const auto xs = std::vector<double>{1.0, 2.0, 3.0, 4.0};
+    c.push(ts.begin(), ts.end(), xs.begin());
+
+    if(c.size() != 3 || c.result().mean() != 3.0) {
+        throw std::logic_error("time_windowed (chrono)");
+    }
+    c.max_age(milliseconds(10));
+    if(c.size() != 1 || c.result().mean() != 4.0) {
+        throw std::logic_error("time_windowed (chrono) max_age");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_hopping_windowed()
+{
+    //windows of 3 panes, hop = 10
+    auto w = hopping_windowed<sum_accumulator<int>>{10, 3};
+
+    auto ends = std::vector<double>{};
+    auto sums = std::vector<int>{};
+    const auto emit = [&](double t, const sum_accumulator<int>& a) {
+        ends.push_back(t);
+        sums.push_back(a.result());
+    };
+
+    for(int t = 0; t < 40; ++t) {
+        w.advance(t, emit);
+        w += 1;
+        if(t >= 20) w += 1;
+    }
+    //panes: [0,10): 10, [10,20): 10, [20,30): 20, [30,40): 20
+    if( !( (ends == std::vector<double>{10, 20, 30})
+        && (sums == std::vector<int>{10, 20, 40})
+        && (w.result().result() == 50)
+        && (w.current_pane().result() == 20) ))
+    {
+        throw std::logic_error("hopping_windowed result");
+    }
+
+    //jump far ahead: only 3 windows can contain data
+    ends.clear();
+    sums.clear();
+    if(w.advance(100, emit) != 7 || w.pane_start() != 100) {
+        throw std::logic_error("hopping_windowed advance");
+    }
+    if( !( (sums == std::vector<int>{50, 40, 20})
+        && (w.result().result() == 0) ))
+    {
+        throw std::logic_error("hopping_windowed expiry");
+    }
+
+    //tumbling window of moments
+    auto m = hopping_windowed<moments_accumulator<double,2>>{5, 1};
+    const auto v = std::vector<double>{1, 2, 3};
+    m.push(v.begin(), v.end());
+    m.push(6.0, 10.0);
+    if(m.result().mean() != 10.0 || m.result().size() != 1) {
+        throw std::logic_error("hopping_windowed (tumbling)");
+    }
+
+    //timestamped push reports the windows it completes
+    auto h = hopping_windowed<sum_accumulator<int>>{10, 2};
+    ends.clear();
+    sums.clear();
+    for(int t = 0; t < 30; t += 5) h.push(t, 1, emit);
+    if( !( (ends == std::vector<double>{10, 20})
+        && (sums == std::vector<int>{2, 4})
+        && (h.result().result() == 4) ))
+    {
+        throw std::logic_error("hopping_windowed push with consumer");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_multi_windowed()
+{
+    auto w = multi_windowed<sum_accumulator<int>>{100, 0, 10, 1000};
+    auto r = std::vector<windowed<sum_accumulator<int>>>(3);
+    r[0].resize_window(10);
+    r[1].resize_window(100);
+    r[2].resize_window(1000);
+
+    auto rnd = std::mt19937{};
+    for(int i = 0; i < 2500; ++i) {
+        const auto x = int(rnd() % 100);
+        w += x;
+        for(auto& a : r) a += x;
+
+        if(i == 50 || i == 500 || i == 2499) {
+            for(std::size_t j = 0; j < 3; ++j) {
+                if(w[j].result() != r[j].result().result() ||
+                   w.size(j) != r[j].size())
+                {
+                    throw std::logic_error("multi_windowed result");
+                }
+            }
+        }
+    }
+    if(w.windows() != 3 || w.window_size(0) != 10 || w.window_size(2) != 1000) {
+        throw std::logic_error("multi_windowed sizes");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_windowed_quantile()
+{
+    constexpr std::size_t w = 37;
+
+    auto acc = windowed_quantile_accumulator<int>{w};
+    auto rnd = std::mt19937{};
+    auto v = std::vector<int>{};
+
+    for(int i = 0; i < 2000; ++i) {
+        const auto x = int(rnd() % 50);
+        acc += x;
+        v.push_back(x);
+
+        const auto first = (v.size() > w) ? v.end() - w : v.begin();
+        auto s = std::vector<int>(first, v.end());
+        std::sort(s.begin(), s.end());
+
+        if(acc.size() != s.size() || acc.median() != s[(s.size()-1)/2]) {
+            throw std::logic_error("windowed_quantile_accumulator median");
+        }
+        for(std::size_t k = 0; k < s.size(); k += 5) {
+            if(acc.nth(k) != s[k]) {
+                throw std::logic_error("windowed_quantile_accumulator nth");
+            }
+        }
+        if(acc.quantile(0) != s.front() || acc.quantile(1) != s.back()) {
+            throw std::logic_error("windowed_quantile_accumulator quantile");
+        }
+    }
+
+    auto d = windowed_quantile_accumulator<double,std::greater<double>>{4};
+    const auto x = std::vector<double>{5, 1, 4, 2, 3};
+    d.push(x.begin(), x.end());
+    //window: 1 4 2 3, descending order
+    if(d.nth(0) != 4.0 || d.quantile(0.5) != 3.0 || d.quantile(0.75) != 2.0) {
+        throw std::logic_error("windowed_quantile_accumulator (comparator)");
+    }
+    d.clear();
+    d += 7.0;
+    if(d.size() != 1 || d.result() != 7.0) {
+        throw std::logic_error("windowed_quantile_accumulator clear");
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_windowed_min_max()
+{
+    constexpr std::size_t w = 7;
+
+    auto mm = windowed_min_max_accumulator<int>{w};
+    auto mx = windowed_max_accumulator<int>{w};
+
+    auto rnd = std::mt19937{};
+    auto v = std::vector<int>{};
+
+    for(int i = 0; i < 1000; ++i) {
+        const auto x = int(rnd() % 100);
+        v.push_back(x);
+        mm += x;
+        mx += x;
+
+        const auto first = v.end() - std::min(v.size(), w);
+        const auto mi = *std::min_element(first, v.end());
+        const auto ma = *std::max_element(first, v.end());
+
+        if(mm.min() != mi || mm.max() != ma || mx.result() != ma ||
+           mm.size() != std::size_t(v.end() - first))
+        {
+            throw std::logic_error("windowed_min_max_accumulator result");
+        }
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+void test_merging_windowed()
+{
+    using std::abs;
+    constexpr std::size_t w = 5;
+
+    auto mx  = merging_windowed<max_accumulator<int>>{w};
+    auto ini = merging_windowed<initial_value_accumulator<int>>{w};
+    auto cur = merging_windowed<current_value_accumulator<int>>{w};
+    auto mom = merging_windowed<moments_accumulator<double,2>>{w};
+
+    auto rnd = std::mt19937{};
+    auto v = std::vector<int>{};
+
+    for(int i = 0; i < 200; ++i) {
+        const auto x = int(rnd() % 1000);
+        v.push_back(x);
+        mx += x;
+        ini += x;
+        cur += x;
+        mom += double(x);
+
+        const auto first = v.end() - std::min(v.size(), w);
+        const auto mean = std::accumulate(first, v.end(), 0.0) / (v.end() - first);
+
+        if( !( (mx.result().result() == *std::max_element(first, v.end()))
+            && (ini.result().result() == *first)
+            && (cur.result().result() == x)
+            && (mom.size() == std::size_t(v.end() - first))
+            && (abs(mom.result().mean() - mean) < 0.0001) ))
+        {
+            throw std::logic_error("merging_windowed result");
+        }
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+int main()
+{
+    try {
+        test_ring_buffer();
+        test_window_buffer();
+        test_windowed();
+        test_time_windowed();
+        test_hopping_windowed();
+        test_multi_windowed();
+        test_windowed_quantile();
+        test_windowed_min_max();
+        test_merging_windowed();
+        test_windowed_histogram();
+        test_interval_windowed_histogram();
+    }
+    catch(std::exception& e) {
+        std::cerr << "wrong " << e.what();
+        return 1;
+    }
+}